@@ -0,0 +1,220 @@
+#pragma once
+
+// Std. Includes
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <system_error>
+#include <vector>
+
+// GL Includes
+#include <GL/glew.h>
+
+// Other includes
+#include "AirfoilLoader.h"
+#include "MappedFile.h"
+#include "VertexAttribute.h"
+
+// Binary profile cache written next to a .out file (foil_spline.out -> foil_spline.out.bin).
+// Layout: one AirfoilCacheHeader followed by pointCount packed (x, y) float pairs, already shifted
+// like ParseOutProfile does. Stored in native byte order. The char magic reads the same in either byte order, so a
+// cache from a machine of the other endianness is rejected by its version instead (1 reads as 0x01000000).
+const char AIRFOIL_CACHE_MAGIC[4] = { 'A', 'F', 'O', 'B' };
+const uint32_t AIRFOIL_CACHE_VERSION = 1;
+// Coarsest file system clock a profile may live on (FAT stamps in 2 s steps). A source written within one tick
+// of its cache can change again without changing its time, so such a cache is checked against the source hash.
+const std::chrono::seconds AIRFOIL_CACHE_CLOCK_TICK(2);
+
+struct AirfoilCacheHeader
+{
+	char magic[4];
+	uint32_t version;
+	uint64_t pointCount;
+	GLfloat minX, minY, maxX, maxY;
+	// The source .out file the cache was converted from
+	uint64_t sourceSize;
+	int64_t sourceTime;
+	uint64_t sourceHash;
+};
+
+// FNV-1a over the source text, only compared for a racy cache (see AIRFOIL_CACHE_CLOCK_TICK)
+inline uint64_t HashOutSource(const char *_data, size_t _size)
+{
+	uint64_t hash = 14695981039346656037ull;
+	for (size_t i = 0; i < _size; i++)
+	{
+		hash ^= (unsigned char)_data[i];
+		hash *= 1099511628211ull;
+	}
+	return hash;
+}
+
+inline std::string GetAirfoilCachePath(const char *_filePath)
+{
+	return std::string(_filePath) + ".bin";
+}
+
+// The cache is valid when the source size and full-resolution time match. Only when the source was written within
+// one clock tick of the cache (the racy-git rule) is the source mapped and its hash compared as well; a racy cache
+// that passes is restamped once the tick has passed, so later runs skip the hash.
+inline bool IsAirfoilCacheFresh(const char *_cachePath, const char *_sourcePath, int64_t _sourceTime, uint64_t _sourceHash)
+{
+	typedef std::filesystem::file_time_type FileTime;
+	const int64_t tick = std::chrono::duration_cast<FileTime::duration>(AIRFOIL_CACHE_CLOCK_TICK).count();
+	std::error_code ec;
+	int64_t cacheTime = (int64_t)std::filesystem::last_write_time(_cachePath, ec).time_since_epoch().count();
+	if (ec)
+	{
+		return false;
+	}
+	if (cacheTime - _sourceTime >= tick)
+	{
+		return true;
+	}
+
+	// Every write stamped _sourceTime happened before _sourceTime + tick, so if that is already past the hash
+	// below sees the final text
+	FileTime now = FileTime::clock::now();
+	MappedFile source;
+	if (!source.Open(_sourcePath) || HashOutSource(source.GetData(), source.GetSize()) != _sourceHash)
+	{
+		return false;
+	}
+	if ((int64_t)now.time_since_epoch().count() - _sourceTime >= tick)
+	{
+		std::filesystem::last_write_time(_cachePath, now, ec);
+	}
+	return true;
+}
+
+// Maps a cache file and copies its points into _vVertex when it is still fresh for the source at _sourcePath
+inline bool ReadAirfoilCache(const char *_cachePath, const char *_sourcePath, uint64_t _sourceSize, int64_t _sourceTime, std::vector<VertexAttribute>& _vVertex)
+{
+	MappedFile cache;
+	std::error_code ec;
+	if (!std::filesystem::exists(_cachePath, ec) || !cache.Open(_cachePath) || cache.GetSize() < sizeof(AirfoilCacheHeader))
+	{
+		return false;
+	}
+
+	AirfoilCacheHeader header;
+	std::memcpy(&header, cache.GetData(), sizeof(header));
+	if (std::memcmp(header.magic, AIRFOIL_CACHE_MAGIC, sizeof(header.magic)) != 0
+		|| header.version != AIRFOIL_CACHE_VERSION
+		|| header.sourceSize != _sourceSize || header.sourceTime != _sourceTime
+		|| cache.GetSize() != sizeof(header) + header.pointCount * 2 * sizeof(GLfloat)
+		|| !IsAirfoilCacheFresh(_cachePath, _sourcePath, _sourceTime, header.sourceHash))
+	{
+		return false;
+	}
+
+	const GLfloat *points = (const GLfloat *)(cache.GetData() + sizeof(header));
+	_vVertex.reserve(_vVertex.size() + header.pointCount);
+	for (uint64_t i = 0; i < header.pointCount; i++)
+	{
+		VertexAttribute vVA = { points[2 * i], points[2 * i + 1], 1.0f, glm::vec3(0.0f, 0.0f, 0.0f) };
+		_vVertex.push_back(vVA);
+	}
+	return true;
+}
+
+// Writes _pointCount vertices starting at _vertex as a cache file. The file is written under a
+// temporary name and renamed so a concurrently starting run never maps a half-written cache.
+inline bool WriteAirfoilCache(const char *_cachePath, const VertexAttribute *_vertex, size_t _pointCount, uint64_t _sourceSize, int64_t _sourceTime, uint64_t _sourceHash)
+{
+	AirfoilCacheHeader header;
+	std::memcpy(header.magic, AIRFOIL_CACHE_MAGIC, sizeof(header.magic));
+	header.version = AIRFOIL_CACHE_VERSION;
+	header.pointCount = _pointCount;
+	header.minX = header.minY = header.maxX = header.maxY = 0.0f;
+	header.sourceSize = _sourceSize;
+	header.sourceTime = _sourceTime;
+	header.sourceHash = _sourceHash;
+
+	std::vector<GLfloat> points;
+	points.reserve(2 * _pointCount);
+	for (size_t i = 0; i < _pointCount; i++)
+	{
+		const VertexAttribute& var = _vertex[i];
+		if (i == 0)
+		{
+			header.minX = header.maxX = var.x;
+			header.minY = header.maxY = var.y;
+		}
+		header.minX = std::min(header.minX, var.x);
+		header.minY = std::min(header.minY, var.y);
+		header.maxX = std::max(header.maxX, var.x);
+		header.maxY = std::max(header.maxY, var.y);
+		points.push_back(var.x);
+		points.push_back(var.y);
+	}
+
+	std::string tempPath = std::string(_cachePath) + ".tmp";
+	FILE *file = std::fopen(tempPath.c_str(), "wb");
+	if (file == nullptr)
+	{
+		return false;
+	}
+	bool written = std::fwrite(&header, sizeof(header), 1, file) == 1
+		&& std::fwrite(points.data(), sizeof(GLfloat), points.size(), file) == points.size();
+	written = (std::fclose(file) == 0) && written;
+
+	std::error_code ec;
+	if (written)
+	{
+		std::filesystem::rename(tempPath, _cachePath, ec);
+	}
+	if (!written || ec)
+	{
+		std::filesystem::remove(tempPath, ec);
+		return false;
+	}
+	return true;
+}
+
+// Loads a .out profile through its binary cache: the cache is mapped directly when it matches the
+// source, otherwise the text is parsed once and the cache is (re)written next to it. A hit on a cache that is not
+// racy never touches the source text.
+inline bool LoadOutProfileCached(const char *_filePath, std::vector<VertexAttribute>& _vVertex)
+{
+	std::error_code ec;
+	uint64_t sourceSize = std::filesystem::file_size(_filePath, ec);
+	if (ec)
+	{
+		std::cout << "ERROR::LOADER::.out_FILE_NOT_SUCCESFULLY_READ" << std::endl;
+		return false;
+	}
+	int64_t sourceTime = (int64_t)std::filesystem::last_write_time(_filePath, ec).time_since_epoch().count();
+
+	std::string cachePath = GetAirfoilCachePath(_filePath);
+	if (ReadAirfoilCache(cachePath.c_str(), _filePath, sourceSize, sourceTime, _vVertex))
+	{
+		return true;
+	}
+
+	MappedFile file;
+	if (!file.Open(_filePath))
+	{
+		std::cout << "ERROR::LOADER::.out_FILE_NOT_SUCCESFULLY_READ" << std::endl;
+		return false;
+	}
+	const uint64_t sourceHash = HashOutSource(file.GetData(), file.GetSize());
+
+	size_t first = _vVertex.size();
+	if (!ParseOutProfile(file.GetData(), file.GetData() + file.GetSize(), _vVertex))
+	{
+		return false;
+	}
+	if (!WriteAirfoilCache(cachePath.c_str(), _vVertex.data() + first, _vVertex.size() - first,
+		sourceSize, sourceTime, sourceHash))
+	{
+		// Not fatal: a read-only profile directory just means the text is parsed on every run
+		std::cout << "WARNING::LOADER::CACHE_NOT_WRITTEN " << cachePath << std::endl;
+	}
+	return true;
+}
@@ -0,0 +1,169 @@
+#pragma once
+
+// Std. Includes
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+// GL Includes
+#include <GL/glew.h>
+
+// Other includes
+#include "AirfoilLoader.h"
+#include "VertexAttribute.h"
+
+// One profile of an AirfoilDatabase: where its points live in the shared store and how long it took
+struct AirfoilProfileEntry
+{
+	std::string path;
+	size_t offset;
+	size_t count;
+	size_t bytes;
+	double seconds;
+	bool loaded;
+};
+
+// Loads a whole directory of .out profiles without any GL context.
+// Files are parsed on a pool of worker threads that pull the next file from a shared counter, then
+// packed into one contiguous vertex store; vEntry is the offset table into vVertex, in file name order.
+class AirfoilDatabase
+{
+public:
+	std::vector<VertexAttribute> vVertex;
+	std::vector<AirfoilProfileEntry> vEntry;
+
+	AirfoilDatabase() : totalBytes(0), totalSeconds(0.0), threadCount(0)
+	{
+	}
+
+	// _threadCount = 0 uses one worker per hardware thread
+	bool LoadDirectory(const char *_directory, unsigned _threadCount = 0, const char *_extension = ".out")
+	{
+		vVertex.clear();
+		vEntry.clear();
+		auto start = std::chrono::steady_clock::now();
+
+		std::error_code ec;
+		for (std::filesystem::directory_iterator it(_directory, ec), last; !ec && it != last; it.increment(ec))
+		{
+			if (it->is_regular_file(ec) && it->path().extension() == _extension)
+			{
+				AirfoilProfileEntry entry = { it->path().string(), 0, 0, 0, 0.0, false };
+				vEntry.push_back(entry);
+			}
+		}
+		if (ec)
+		{
+			std::cout << "ERROR::DATABASE::DIRECTORY_NOT_SUCCESFULLY_READ " << _directory << std::endl;
+			return false;
+		}
+		std::sort(vEntry.begin(), vEntry.end(), [](const AirfoilProfileEntry& _a, const AirfoilProfileEntry& _b) { return _a.path < _b.path; });
+
+		this->threadCount = (_threadCount != 0) ? _threadCount : std::max(1u, std::thread::hardware_concurrency());
+		this->threadCount = std::min<unsigned>(this->threadCount, std::max<size_t>(vEntry.size(), 1));
+
+		// 1. Parse every file into its own vector, balancing files across the workers
+		std::vector<std::vector<VertexAttribute>> vProfile(vEntry.size());
+		std::atomic<size_t> nextFile(0);
+		RunWorkers([&]()
+		{
+			for (size_t i = nextFile++; i < vEntry.size(); i = nextFile++)
+			{
+				auto fileStart = std::chrono::steady_clock::now();
+				MappedFile file;
+				AirfoilProfileEntry& entry = vEntry[i];
+				if (file.Open(entry.path.c_str()))
+				{
+					entry.bytes = file.GetSize();
+					entry.loaded = ParseOutProfile(file.GetData(), file.GetData() + file.GetSize(), vProfile[i]);
+				}
+				entry.count = vProfile[i].size();
+				entry.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - fileStart).count();
+			}
+		});
+
+		// 2. Lay the profiles out back to back and copy them into the shared store in parallel
+		size_t total = 0;
+		for (AirfoilProfileEntry& entry : vEntry)
+		{
+			entry.offset = total;
+			total += entry.count;
+		}
+		vVertex.resize(total);
+		nextFile = 0;
+		RunWorkers([&]()
+		{
+			for (size_t i = nextFile++; i < vEntry.size(); i = nextFile++)
+			{
+				if (!vProfile[i].empty())
+				{
+					std::memcpy(&vVertex[vEntry[i].offset], vProfile[i].data(), vProfile[i].size() * sizeof(VertexAttribute));
+				}
+				std::vector<VertexAttribute>().swap(vProfile[i]);
+			}
+		});
+
+		this->totalBytes = 0;
+		bool allLoaded = true;
+		for (const AirfoilProfileEntry& entry : vEntry)
+		{
+			this->totalBytes += entry.bytes;
+			allLoaded = allLoaded && entry.loaded;
+		}
+		this->totalSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		return allLoaded;
+	}
+
+	// Prints one line per profile (when _perFile is set) followed by the total throughput
+	void Report(std::ostream& _out, bool _perFile = true) const
+	{
+		if (_perFile)
+		{
+			for (const AirfoilProfileEntry& entry : vEntry)
+			{
+				_out << entry.path << ": " << entry.count << " points, " << entry.seconds * 1000.0 << " ms"
+					<< (entry.loaded ? "" : " (FAILED)") << std::endl;
+			}
+		}
+		_out << vEntry.size() << " files, " << vVertex.size() << " points on " << this->threadCount << " threads in "
+			<< this->totalSeconds * 1000.0 << " ms: " << this->totalBytes / this->totalSeconds / (1024.0 * 1024.0) << " MB/s, "
+			<< vEntry.size() / this->totalSeconds << " files/s" << std::endl;
+	}
+
+	size_t GetTotalBytes() const
+	{
+		return this->totalBytes;
+	}
+
+	double GetTotalSeconds() const
+	{
+		return this->totalSeconds;
+	}
+
+private:
+	size_t totalBytes;
+	double totalSeconds;
+	unsigned threadCount;
+
+	template <class Work>
+	void RunWorkers(Work _work)
+	{
+		std::vector<std::thread> vThread;
+		for (unsigned i = 1; i < this->threadCount; i++)
+		{
+			vThread.emplace_back(_work);
+		}
+		_work();
+		for (std::thread& thread : vThread)
+		{
+			thread.join();
+		}
+	}
+};
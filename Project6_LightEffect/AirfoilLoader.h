@@ -0,0 +1,346 @@
+#pragma once
+
+// Std. Includes
+#include <charconv>
+#include <cstdio>
+#include <cstring>
+#include <cstddef>
+#include <iostream>
+#include <vector>
+
+// GL Includes
+#include <GL/glew.h>
+
+// Other includes
+#include "MappedFile.h"
+#include "VertexAttribute.h"
+
+// Kinds of lines found in a .out profile: a point count header or an "x<TAB>y" coordinate row
+enum OutLineType
+{
+	OUT_LINE_EMPTY,
+	OUT_LINE_COUNT,
+	OUT_LINE_POINT,
+	OUT_LINE_INVALID
+};
+
+inline const char *SkipOutBlanks(const char *_cursor, const char *_end)
+{
+	while (_cursor != _end && (*_cursor == ' ' || *_cursor == '\t'))
+	{
+		_cursor++;
+	}
+	return _cursor;
+}
+
+// Scans the line starting at _cursor without allocating and advances _cursor to the start of the next line.
+// Only the first two tokens of a coordinate row are used, like the original stringstream parser.
+inline OutLineType ScanOutLine(const char *&_cursor, const char *_end, size_t& _count, GLfloat& _x, GLfloat& _y)
+{
+	OutLineType type = OUT_LINE_INVALID;
+	const char *p = SkipOutBlanks(_cursor, _end);
+	if (p == _end || *p == '\n' || *p == '\r')
+	{
+		type = OUT_LINE_EMPTY;
+	}
+	else
+	{
+		const char *first = p;
+		std::from_chars_result result = std::from_chars(p, _end, _x);
+		if (result.ec == std::errc())
+		{
+			p = SkipOutBlanks(result.ptr, _end);
+			if (p == _end || *p == '\n' || *p == '\r')
+			{
+				// A single token is the point count of the profile that follows
+				if (std::from_chars(first, _end, _count).ec == std::errc())
+				{
+					type = OUT_LINE_COUNT;
+				}
+			}
+			else
+			{
+				result = std::from_chars(p, _end, _y);
+				if (result.ec == std::errc())
+				{
+					p = result.ptr;
+					type = OUT_LINE_POINT;
+				}
+			}
+		}
+	}
+
+	while (p != _end && *p != '\n')
+	{
+		p++;
+	}
+	_cursor = (p == _end) ? p : p + 1;
+	return type;
+}
+
+// Parses a whole .out profile held in memory into _vVertex in a single pass.
+// Points are shifted so that the first one sits at the origin and placed on z = 1, and at most
+// the announced number of points is kept. The only allocation is the reserve for that count.
+inline bool ParseOutProfile(const char *_begin, const char *_end, std::vector<VertexAttribute>& _vVertex)
+{
+	size_t capacity = 0, verticesIndex = 0, count = 0;
+	GLfloat firstX = 0.0f, firstY = 0.0f, x = 0.0f, y = 0.0f;
+	const char *cursor = _begin;
+	while (cursor != _end)
+	{
+		switch (ScanOutLine(cursor, _end, count, x, y))
+		{
+		case OUT_LINE_COUNT:
+			if (verticesIndex != 0)
+			{
+				std::cout << "ERROR::LOADER::VERTEX_SIZE_CHANGED" << std::endl;
+				return false;
+			}
+			capacity = count;
+			_vVertex.reserve(_vVertex.size() + capacity);
+			break;
+		case OUT_LINE_POINT:
+			if (verticesIndex == 0)
+			{
+				firstX = x;
+				firstY = y;
+			}
+			if (verticesIndex++ < capacity)
+			{
+				VertexAttribute vVA = { x - firstX, y - firstY, 1.0f, glm::vec3(0.0f, 0.0f, 0.0f) };
+				_vVertex.push_back(vVA);
+			}
+			break;
+		case OUT_LINE_INVALID:
+			std::cout << "ERROR::LOADER::MALFORMED_LINE" << std::endl;
+			return false;
+		default:
+			break;
+		}
+	}
+	return true;
+}
+
+// Memory-maps a .out file and parses it straight into _vVertex
+inline bool LoadOutProfile(const char *_filePath, std::vector<VertexAttribute>& _vVertex)
+{
+	MappedFile file;
+	if (!file.Open(_filePath))
+	{
+		std::cout << "ERROR::LOADER::.out_FILE_NOT_SUCCESFULLY_READ" << std::endl;
+		return false;
+	}
+	return ParseOutProfile(file.GetData(), file.GetData() + file.GetSize(), _vVertex);
+}
+
+// Streams a sweep file holding many "count + points" sections one section at a time.
+// The file is read through a fixed-size chunk buffer and each section is parsed into a vector the
+// caller keeps reusing, so memory stays bounded by the chunk size plus the largest section no matter
+// how big the file grows. Every section is shifted to its own first point like ParseOutProfile.
+class AirfoilSectionReader
+{
+public:
+	AirfoilSectionReader(size_t _chunkSize = 1 << 20) : file(nullptr), begin(0), end(0), endOfFile(false), error(false), pendingCount(false), pendingCountValue(0), sectionIndex(0)
+	{
+		this->buffer.resize(_chunkSize);
+	}
+
+	~AirfoilSectionReader()
+	{
+		this->Close();
+	}
+
+	AirfoilSectionReader(const AirfoilSectionReader&) = delete;
+	AirfoilSectionReader& operator=(const AirfoilSectionReader&) = delete;
+
+	bool Open(const char *_filePath)
+	{
+		this->Close();
+		this->file = std::fopen(_filePath, "rb");
+		if (this->file == nullptr)
+		{
+			std::cout << "ERROR::LOADER::.out_FILE_NOT_SUCCESFULLY_READ " << _filePath << std::endl;
+			return false;
+		}
+		return true;
+	}
+
+	void Close()
+	{
+		if (this->file != nullptr)
+		{
+			std::fclose(this->file);
+		}
+		this->file = nullptr;
+		this->begin = this->end = 0;
+		this->endOfFile = this->error = this->pendingCount = false;
+		this->sectionIndex = 0;
+	}
+
+	// Parses the next section into _vSection, reusing its capacity.
+	// Returns false at the end of the file or on a malformed line (see HasError()).
+	bool NextSection(std::vector<VertexAttribute>& _vSection)
+	{
+		_vSection.clear();
+		if (this->file == nullptr || this->error)
+		{
+			return false;
+		}
+
+		const char *line, *lineEnd;
+		size_t capacity = 0, count = 0;
+		GLfloat x = 0.0f, y = 0.0f;
+		if (this->pendingCount)
+		{
+			capacity = this->pendingCountValue;
+			this->pendingCount = false;
+		}
+		else
+		{
+			// Find the count header that opens the section
+			for (;;)
+			{
+				if (!this->NextLine(line, lineEnd))
+				{
+					return false;
+				}
+				OutLineType type = ScanOutLine(line, lineEnd, count, x, y);
+				if (type == OUT_LINE_COUNT)
+				{
+					capacity = count;
+					break;
+				}
+				if (type != OUT_LINE_EMPTY)
+				{
+					std::cout << "ERROR::LOADER::SECTION_WITHOUT_COUNT" << std::endl;
+					this->error = true;
+					return false;
+				}
+			}
+		}
+
+		_vSection.reserve(capacity);
+		size_t verticesIndex = 0;
+		GLfloat firstX = 0.0f, firstY = 0.0f;
+		while (this->NextLine(line, lineEnd))
+		{
+			OutLineType type = ScanOutLine(line, lineEnd, count, x, y);
+			if (type == OUT_LINE_COUNT)
+			{
+				// Header of the next section: keep it for the following call
+				this->pendingCount = true;
+				this->pendingCountValue = count;
+				break;
+			}
+			if (type == OUT_LINE_INVALID)
+			{
+				std::cout << "ERROR::LOADER::MALFORMED_LINE in section " << this->sectionIndex << std::endl;
+				this->error = true;
+				return false;
+			}
+			if (type == OUT_LINE_POINT)
+			{
+				if (verticesIndex == 0)
+				{
+					firstX = x;
+					firstY = y;
+				}
+				if (verticesIndex++ < capacity)
+				{
+					VertexAttribute vVA = { x - firstX, y - firstY, 1.0f, glm::vec3(0.0f, 0.0f, 0.0f) };
+					_vSection.push_back(vVA);
+				}
+			}
+		}
+		if (this->error)
+		{
+			return false;
+		}
+
+		this->sectionIndex++;
+		return true;
+	}
+
+	bool HasError() const
+	{
+		return this->error;
+	}
+
+	// Number of sections returned so far
+	size_t GetSectionCount() const
+	{
+		return this->sectionIndex;
+	}
+
+private:
+	FILE *file;
+	std::vector<char> buffer;
+	size_t begin, end;
+	bool endOfFile, error;
+	bool pendingCount;
+	size_t pendingCountValue;
+	size_t sectionIndex;
+
+	// Hands out the next complete line (including its '\n') from the chunk buffer, refilling it as needed
+	bool NextLine(const char *&_line, const char *&_lineEnd)
+	{
+		for (;;)
+		{
+			const char *first = this->buffer.data() + this->begin;
+			const char *newline = (const char *)std::memchr(first, '\n', this->end - this->begin);
+			if (newline != nullptr || (this->endOfFile && this->begin != this->end))
+			{
+				_line = first;
+				_lineEnd = (newline != nullptr) ? newline + 1 : this->buffer.data() + this->end;
+				this->begin = _lineEnd - this->buffer.data();
+				return true;
+			}
+			if (this->endOfFile)
+			{
+				return false;
+			}
+
+			// Move the partial line to the front; only a line longer than the whole chunk grows the buffer
+			std::memmove(this->buffer.data(), first, this->end - this->begin);
+			this->end -= this->begin;
+			this->begin = 0;
+			if (this->end == this->buffer.size())
+			{
+				this->buffer.resize(this->buffer.size() * 2);
+			}
+			size_t read = std::fread(this->buffer.data() + this->end, 1, this->buffer.size() - this->end, this->file);
+			this->end += read;
+			if (read == 0)
+			{
+				this->endOfFile = true;
+				if (std::ferror(this->file))
+				{
+					std::cout << "ERROR::LOADER::READ_FAILED" << std::endl;
+					this->error = true;
+					return false;
+				}
+			}
+		}
+	}
+};
+
+// Streams every section of a sweep file into _callback(sectionIndex, vSection).
+// The callback returns false to stop early; sections are handed over while the file is still being read.
+template <class Callback>
+bool ForEachOutSection(const char *_filePath, Callback _callback, size_t _chunkSize = 1 << 20)
+{
+	AirfoilSectionReader reader(_chunkSize);
+	if (!reader.Open(_filePath))
+	{
+		return false;
+	}
+	std::vector<VertexAttribute> vSection;
+	while (reader.NextSection(vSection))
+	{
+		if (!_callback(reader.GetSectionCount() - 1, vSection))
+		{
+			break;
+		}
+	}
+	return !reader.HasError();
+}
@@ -0,0 +1,110 @@
+#pragma once
+
+// Std. Includes
+#include <atomic>
+#include <functional>
+#include <iostream>
+#include <thread>
+
+// GL Includes
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+
+// Runs a loading job on a worker thread that owns a hidden window sharing the render context.
+// Buffers and textures created by the job are visible to the render context; the job's uploads are
+// fenced so the render loop can poll for them without ever blocking. Container objects (VAOs) are
+// not shared between contexts, so the render thread builds those itself once Poll() succeeds.
+class AssetLoader
+{
+public:
+	AssetLoader() : window(nullptr), fence(nullptr), finished(false), ready(false)
+	{
+	}
+
+	~AssetLoader()
+	{
+		this->Release();
+	}
+
+	AssetLoader(const AssetLoader&) = delete;
+	AssetLoader& operator=(const AssetLoader&) = delete;
+
+	// Must be called on the main thread: GLFW only creates windows there
+	bool Start(GLFWwindow *_sharedWith, std::function<void()> _job)
+	{
+		glfwWindowHint(GLFW_VISIBLE, GL_FALSE);
+		this->window = glfwCreateWindow(1, 1, "AssetLoader", nullptr, _sharedWith);
+		glfwWindowHint(GLFW_VISIBLE, GL_TRUE);
+		if (nullptr == this->window)
+		{
+			std::cout << "ERROR::ASSETLOADER::SHARED_CONTEXT_NOT_CREATED" << std::endl;
+			return false;
+		}
+
+		this->thread = std::thread([this, _job]()
+		{
+			glfwMakeContextCurrent(this->window);
+			_job();
+			// Make the uploads visible to the render context before handing them over
+			this->fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+			glFlush();
+			glfwMakeContextCurrent(nullptr);
+			this->finished.store(true, std::memory_order_release);
+		});
+		return true;
+	}
+
+	// Non-blocking check from the render thread: true once the job ran and the GPU finished its uploads
+	bool Poll()
+	{
+		if (this->ready)
+		{
+			return true;
+		}
+		if (!this->finished.load(std::memory_order_acquire))
+		{
+			return false;
+		}
+		GLenum status = glClientWaitSync(this->fence, 0, 0);
+		if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED)
+		{
+			return false;
+		}
+		glDeleteSync(this->fence);
+		this->fence = nullptr;
+		this->Join();
+		this->ready = true;
+		return true;
+	}
+
+	void Join()
+	{
+		if (this->thread.joinable())
+		{
+			this->thread.join();
+		}
+	}
+
+	// Waits for the job and destroys the loader window; call before glfwTerminate
+	void Release()
+	{
+		this->Join();
+		if (this->fence != nullptr)
+		{
+			glDeleteSync(this->fence);
+			this->fence = nullptr;
+		}
+		if (this->window != nullptr)
+		{
+			glfwDestroyWindow(this->window);
+			this->window = nullptr;
+		}
+	}
+
+private:
+	GLFWwindow *window;
+	std::thread thread;
+	GLsync fence;
+	std::atomic<bool> finished;
+	bool ready;
+};
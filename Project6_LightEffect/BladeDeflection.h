@@ -0,0 +1,94 @@
+#pragma once
+
+// Std. Includes
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+// GL Includes
+#include <GL/glew.h>
+
+#include <glm/glm.hpp>
+
+// Other includes
+#include "VertexAttribute.h"
+
+// Flapwise bending and twist of a blade along its span, as polynomials in the span fraction s (0 at the root,
+// 1 at the tip). A section moves by Bend(s) along y, across the chord, and turns by Twist(s) radians about the span
+// axis. Bending starts at s^2 and twist at s, so the root stays clamped. core.vertexshader evaluates the same
+// polynomials (with TERMS coefficients each) when SetUniforms has handed them over.
+struct BladeDeflection
+{
+	static const size_t TERMS = 4;
+	GLfloat bend[TERMS];	// Bend(s) = bend[0] s^2 + bend[1] s^3 + ...
+	GLfloat twist[TERMS];	// Twist(s) = twist[0] s + twist[1] s^2 + ...
+
+	BladeDeflection()
+	{
+		for (size_t k = 0; k < TERMS; k++)
+		{
+			this->bend[k] = this->twist[k] = 0.0f;
+		}
+	}
+
+	GLfloat Bend(const GLfloat _s) const
+	{
+		GLfloat sum = 0.0f;
+		for (size_t k = TERMS; k-- > 0;)
+		{
+			sum = sum * _s + this->bend[k];
+		}
+		return sum * _s * _s;
+	}
+
+	GLfloat Twist(const GLfloat _s) const
+	{
+		GLfloat sum = 0.0f;
+		for (size_t k = TERMS; k-- > 0;)
+		{
+			sum = sum * _s + this->twist[k];
+		}
+		return sum * _s;
+	}
+
+	glm::vec3 Apply(const glm::vec3& _position, const GLfloat _s) const
+	{
+		const GLfloat angle = this->Twist(_s), c = std::cos(angle), s = std::sin(angle);
+		return glm::vec3(c * _position.x - s * _position.y, s * _position.x + c * _position.y + this->Bend(_s), _position.z);
+	}
+
+	// A playback frame at _time seconds: the first bending mode (tip deflection _tipBend) at _hertz and the first
+	// twist mode (tip twist _tipTwist) a quarter period behind it
+	static BladeDeflection Playback(const GLfloat _time, const GLfloat _tipBend, const GLfloat _tipTwist, const GLfloat _hertz)
+	{
+		const GLfloat phase = 2.0f * 3.14159265f * _hertz * _time;
+		BladeDeflection deflection;
+		deflection.bend[0] = _tipBend * std::sin(phase);
+		deflection.twist[0] = _tipTwist * std::cos(phase);
+		return deflection;
+	}
+
+	// Deflects the next draws in core.vertexshader, where a vertex of span k is at s = k / _foilMax like in
+	// DeflectPositions, and z grows by _spanLength per unit of s (for the slope of the normals). Set deflect back to
+	// 0 afterwards.
+	void SetUniforms(GLuint _program, const GLuint _foilMax, const GLfloat _spanLength) const
+	{
+		glUniform1i(glGetUniformLocation(_program, "deflect"), 1);
+		glUniform1fv(glGetUniformLocation(_program, "bend"), (GLsizei)TERMS, this->bend);
+		glUniform1fv(glGetUniformLocation(_program, "twist"), (GLsizei)TERMS, this->twist);
+		glUniform1i(glGetUniformLocation(_program, "foilMax"), (GLint)_foilMax);
+		glUniform1f(glGetUniformLocation(_program, "spanLength"), std::max(_spanLength, 1e-6f));
+	}
+};
+
+// Deflects the positions of _vRest into _vOut[0 .. _vRest.size()), writing every element once and reading none, so
+// _vOut can be mapped GPU memory. A vertex of span k is at s = k / _foilMax, the same fraction core.vertexshader uses.
+inline void DeflectPositions(const std::vector<VertexAttribute>& _vRest, const BladeDeflection& _deflection, const GLuint _foilMax, glm::vec3* _vOut)
+{
+	const GLfloat inverseSpan = (_foilMax > 0) ? 1.0f / (GLfloat)_foilMax : 0.0f;
+	for (size_t v = 0; v < _vRest.size(); v++)
+	{
+		const VertexAttribute& var = _vRest[v];
+		_vOut[v] = _deflection.Apply(glm::vec3(var.x, var.y, var.z), var.span * inverseSpan);
+	}
+}
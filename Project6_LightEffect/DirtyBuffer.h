@@ -0,0 +1,132 @@
+#pragma once
+
+// Std. Includes
+#include <algorithm>
+#include <vector>
+
+// GL Includes
+#include <GL/glew.h>
+
+// Half-open range of elements [begin, end) changed since the last upload
+struct DirtyRange
+{
+	size_t begin;
+	size_t end;
+
+	DirtyRange() : begin(0), end(0)
+	{
+	}
+
+	void Add(const size_t _begin, const size_t _end)
+	{
+		if (_begin >= _end)
+		{
+			return;
+		}
+		if (this->Empty())
+		{
+			this->begin = _begin;
+			this->end = _end;
+		}
+		else
+		{
+			this->begin = std::min(this->begin, _begin);
+			this->end = std::max(this->end, _end);
+		}
+	}
+
+	bool Empty() const
+	{
+		return this->begin >= this->end;
+	}
+
+	void Clear()
+	{
+		this->begin = 0;
+		this->end = 0;
+	}
+};
+
+// GPU copy of a vector that is edited in place. Only the elements marked dirty are sent, with one
+// glBufferSubData per upload; everything else stays resident. When the vector outgrows the buffer its storage
+// is grown geometrically and the old contents are carried over with GPU-side copies, so the buffer name (and
+// every VAO using it) stays valid and nothing clean is uploaded again.
+template <class T>
+class DirtyBuffer
+{
+public:
+	DirtyBuffer() : buffer(0), capacity(0)
+	{
+	}
+
+	// Takes over a buffer whose storage holds exactly _count elements
+	void Attach(const GLuint _buffer, const size_t _count)
+	{
+		this->buffer = _buffer;
+		this->capacity = _count;
+		this->dirty.Clear();
+	}
+
+	void Mark(const DirtyRange& _range)
+	{
+		this->dirty.Add(_range.begin, _range.end);
+	}
+
+	// Sends the dirty elements of _vData and returns the number of bytes uploaded
+	size_t Upload(const std::vector<T>& _vData)
+	{
+		this->dirty.end = std::min(this->dirty.end, _vData.size());
+		if (0 == this->buffer || this->dirty.Empty())
+		{
+			this->dirty.Clear();
+			return 0;
+		}
+		if (_vData.size() > this->capacity)
+		{
+			this->Grow(std::max(_vData.size(), 2 * this->capacity));
+		}
+
+		size_t bytes = sizeof(T) * (this->dirty.end - this->dirty.begin);
+		glBindBuffer(GL_COPY_WRITE_BUFFER, this->buffer);
+		glBufferSubData(GL_COPY_WRITE_BUFFER, sizeof(T) * this->dirty.begin, bytes, &_vData[this->dirty.begin]);
+		glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+		this->dirty.Clear();
+		return bytes;
+	}
+
+	size_t GetCapacity() const
+	{
+		return this->capacity;
+	}
+
+private:
+	GLuint buffer;
+	size_t capacity;	// Elements the buffer storage can hold
+	DirtyRange dirty;
+
+	void Grow(const size_t _capacity)
+	{
+		const GLsizeiptr oldBytes = sizeof(T) * this->capacity;
+		GLuint scratch = 0;
+		if (oldBytes > 0)
+		{
+			glGenBuffers(1, &scratch);
+			glBindBuffer(GL_COPY_WRITE_BUFFER, scratch);
+			glBufferData(GL_COPY_WRITE_BUFFER, oldBytes, NULL, GL_STREAM_COPY);
+			glBindBuffer(GL_COPY_READ_BUFFER, this->buffer);
+			glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, oldBytes);
+		}
+
+		glBindBuffer(GL_COPY_WRITE_BUFFER, this->buffer);
+		glBufferData(GL_COPY_WRITE_BUFFER, sizeof(T) * _capacity, NULL, GL_STATIC_DRAW);
+		if (oldBytes > 0)
+		{
+			glBindBuffer(GL_COPY_READ_BUFFER, scratch);
+			glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, oldBytes);
+			glDeleteBuffers(1, &scratch);
+		}
+		glBindBuffer(GL_COPY_READ_BUFFER, 0);
+		glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+		this->capacity = _capacity;
+	}
+};
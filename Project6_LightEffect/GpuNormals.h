@@ -0,0 +1,235 @@
+#pragma once
+
+// Std. Includes
+#include <algorithm>
+#include <string>
+#include <fstream>
+#include <sstream>
+#include <iostream>
+#include <vector>
+
+// GL Includes
+#include <GL/glew.h>
+
+// Other includes
+#include "NormalEngine.h"
+
+// Recomputes the smooth normals of a deforming mesh on the GPU with transform feedback, which every GL 3.3 context
+// has. normals.vertexshader runs once per vertex over texture buffer views of the position and index buffers, sums
+// the normals of the vertex's faces (weighted by unit, area or corner angle like NormalEngine::Compute) through the
+// same CSR adjacency NormalEngine builds, and writes the normal
+// into normalBuffer. The positions are never read back and the normals never leave the GPU: BindAttribute points a
+// VAO's normal attribute at normalBuffer. Only the adjacency is uploaded, once per topology. Vertices that
+// SplitCreases split keep their own faces in the adjacency, so the creases stay sharp.
+class GpuNormals
+{
+public:
+	GpuNormals() : program(0), VAO(0), normalBuffer(0), offsetBuffer(0), faceBuffer(0), positionStride(3), vertexCount(0), faceBytes(0)
+	{
+		for (GLuint& texture : this->textures)
+		{
+			texture = 0;
+		}
+	}
+
+	~GpuNormals()
+	{
+		this->Release();
+	}
+
+	GpuNormals(const GpuNormals&) = delete;
+	GpuNormals& operator=(const GpuNormals&) = delete;
+
+	// Compiles _vertexPath and links it with its "normal" output captured; returns false if that fails
+	bool Load(const GLchar* _vertexPath)
+	{
+		std::string vertexCode;
+		std::ifstream vShaderFile(_vertexPath);
+		if (!vShaderFile)
+		{
+			std::cout << "ERROR::GPUNORMALS::FILE_NOT_SUCCESFULLY_READ" << std::endl;
+			return false;
+		}
+		std::stringstream vShaderStream;
+		vShaderStream << vShaderFile.rdbuf();
+		vertexCode = vShaderStream.str();
+		const GLchar* vShaderCode = vertexCode.c_str();
+
+		GLint success;
+		GLchar infoLog[512];
+		GLuint vertex = glCreateShader(GL_VERTEX_SHADER);
+		glShaderSource(vertex, 1, &vShaderCode, NULL);
+		glCompileShader(vertex);
+		glGetShaderiv(vertex, GL_COMPILE_STATUS, &success);
+		if (!success)
+		{
+			glGetShaderInfoLog(vertex, 512, NULL, infoLog);
+			std::cout << "ERROR::GPUNORMALS::VERTEX::COMPILATION_FAILED\n" << infoLog << std::endl;
+			glDeleteShader(vertex);
+			return false;
+		}
+		this->program = glCreateProgram();
+		glAttachShader(this->program, vertex);
+		// The captured outputs have to be named before linking
+		const GLchar* varyings[] = { "normal" };
+		glTransformFeedbackVaryings(this->program, 1, varyings, GL_INTERLEAVED_ATTRIBS);
+		glLinkProgram(this->program);
+		glDeleteShader(vertex);
+		glGetProgramiv(this->program, GL_LINK_STATUS, &success);
+		if (!success)
+		{
+			glGetProgramInfoLog(this->program, 512, NULL, infoLog);
+			std::cout << "ERROR::GPUNORMALS::PROGRAM::LINKING_FAILED\n" << infoLog << std::endl;
+			glDeleteProgram(this->program);
+			this->program = 0;
+			return false;
+		}
+
+		glGenVertexArrays(1, &this->VAO);
+		glGenBuffers(1, &this->normalBuffer);
+		glGenBuffers(1, &this->offsetBuffer);
+		glGenBuffers(1, &this->faceBuffer);
+		glGenTextures(4, this->textures);
+		return true;
+	}
+
+	// Points the pass at a mesh: _positionBuffer holds _positionStride floats per vertex, _EBO the triangle list of
+	// _topology (whose adjacency has to be built). Uploads the adjacency and sizes normalBuffer; returns false if
+	// the program is not loaded or a buffer is larger than the buffer textures allow.
+	bool SetMesh(const GLuint _positionBuffer, const GLuint _positionStride, const GLuint _EBO, const NormalEngine& _topology)
+	{
+		this->vertexCount = 0;
+		if (0 == this->program || _topology.vFaceOffset.empty())
+		{
+			return false;
+		}
+		const size_t vertices = _topology.vFaceOffset.size() - 1;
+		GLint maxTexels = 0;
+		glGetIntegerv(GL_MAX_TEXTURE_BUFFER_SIZE, &maxTexels);
+		// The whole position buffer is one texture: Compute may fetch from any offset in it (a later ring region of
+		// a StreamBuffer, say), and texels past the limit would silently read 0
+		GLint64 positionBytes = 0;
+		glBindBuffer(GL_TEXTURE_BUFFER, _positionBuffer);
+		glGetBufferParameteri64v(GL_TEXTURE_BUFFER, GL_BUFFER_SIZE, &positionBytes);
+		glBindBuffer(GL_TEXTURE_BUFFER, 0);
+		const size_t positionTexels = std::max((size_t)positionBytes / sizeof(GLfloat), (size_t)_positionStride * vertices);
+		if (positionTexels > (size_t)maxTexels || _topology.vFace.size() > (size_t)maxTexels)
+		{
+			std::cout << "ERROR::GPUNORMALS::MESH_TOO_LARGE for " << maxTexels << " buffer texels" << std::endl;
+			return false;
+		}
+
+		// The offsets are 32 bits on the GPU, like the indices they count
+		std::vector<GLuint> vOffset(_topology.vFaceOffset.begin(), _topology.vFaceOffset.end());
+		glBindBuffer(GL_TEXTURE_BUFFER, this->offsetBuffer);
+		glBufferData(GL_TEXTURE_BUFFER, sizeof(GLuint) * vOffset.size(), vOffset.data(), GL_STATIC_DRAW);
+		glBindBuffer(GL_TEXTURE_BUFFER, this->faceBuffer);
+		glBufferData(GL_TEXTURE_BUFFER, sizeof(GLuint) * _topology.vFace.size(), _topology.vFace.data(), GL_STATIC_DRAW);
+		glBindBuffer(GL_TEXTURE_BUFFER, this->normalBuffer);
+		glBufferData(GL_TEXTURE_BUFFER, 3 * sizeof(GLfloat) * vertices, NULL, GL_DYNAMIC_COPY);
+		glBindBuffer(GL_TEXTURE_BUFFER, 0);
+
+		this->Attach(POSITIONS, GL_R32F, _positionBuffer);
+		this->Attach(INDICES, GL_R32UI, _EBO);
+		this->Attach(OFFSETS, GL_R32UI, this->offsetBuffer);
+		this->Attach(FACES, GL_R32UI, this->faceBuffer);
+		this->positionStride = _positionStride;
+		this->vertexCount = (GLsizei)vertices;
+		this->faceBytes = sizeof(GLuint) * _topology.vFace.size();
+		return true;
+	}
+
+	// Recomputes every normal from the positions now in the position buffer, the first vertex starting at float
+	// _positionOffset, with the faces weighted like NormalEngine::Compute with _weight. Leaves no program bound.
+	void Compute(const GLint _positionOffset = 0, const NormalWeight _weight = NORMAL_WEIGHT_UNIT)
+	{
+		if (0 == this->vertexCount)
+		{
+			return;
+		}
+		glUseProgram(this->program);
+		const GLchar* names[] = { "positions", "indices", "faceOffset", "faces" };
+		for (GLint unit = 0; unit < 4; unit++)
+		{
+			glActiveTexture(GL_TEXTURE0 + unit);
+			glBindTexture(GL_TEXTURE_BUFFER, this->textures[unit]);
+			glUniform1i(glGetUniformLocation(this->program, names[unit]), unit);
+		}
+		glUniform1i(glGetUniformLocation(this->program, "positionStride"), (GLint)this->positionStride);
+		glUniform1i(glGetUniformLocation(this->program, "positionOffset"), _positionOffset);
+		glUniform1i(glGetUniformLocation(this->program, "weight"), (GLint)_weight);
+
+		glEnable(GL_RASTERIZER_DISCARD);
+		glBindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 0, this->normalBuffer);
+		glBindVertexArray(this->VAO);
+		glBeginTransformFeedback(GL_POINTS);
+		glDrawArrays(GL_POINTS, 0, this->vertexCount);
+		glEndTransformFeedback();
+		glBindVertexArray(0);
+		glBindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 0, 0);
+		glDisable(GL_RASTERIZER_DISCARD);
+
+		for (GLint unit = 3; unit >= 0; unit--)
+		{
+			glActiveTexture(GL_TEXTURE0 + unit);
+			glBindTexture(GL_TEXTURE_BUFFER, 0);
+		}
+		glUseProgram(0);
+	}
+
+	// Sources normal attribute _vn of the bound VAO from the computed normals
+	void BindAttribute(const GLuint _vn) const
+	{
+		glBindBuffer(GL_ARRAY_BUFFER, this->normalBuffer);
+		glEnableVertexAttribArray(_vn);
+		glVertexAttribPointer(_vn, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(GLfloat), (GLvoid*)0);
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+	}
+
+	// Bytes of the adjacency and normals resident on the GPU
+	size_t GetUploadedBytes() const
+	{
+		return (this->vertexCount == 0) ? 0 : sizeof(GLuint) * (this->vertexCount + 1) + 3 * sizeof(GLfloat) * this->vertexCount + this->faceBytes;
+	}
+
+	bool Ready() const
+	{
+		return this->vertexCount != 0;
+	}
+
+	void Release()
+	{
+		if (0 != this->program)
+		{
+			glDeleteTextures(4, this->textures);
+			glDeleteBuffers(1, &this->faceBuffer);
+			glDeleteBuffers(1, &this->offsetBuffer);
+			glDeleteBuffers(1, &this->normalBuffer);
+			glDeleteVertexArrays(1, &this->VAO);
+			glDeleteProgram(this->program);
+		}
+		this->program = this->VAO = this->normalBuffer = this->offsetBuffer = this->faceBuffer = 0;
+		for (GLuint& texture : this->textures)
+		{
+			texture = 0;
+		}
+		this->vertexCount = 0;
+	}
+
+private:
+	enum Texture { POSITIONS = 0, INDICES = 1, OFFSETS = 2, FACES = 3 };
+
+	GLuint program, VAO;
+	GLuint normalBuffer, offsetBuffer, faceBuffer;
+	GLuint textures[4];
+	GLuint positionStride;
+	GLsizei vertexCount;
+	size_t faceBytes;
+
+	void Attach(const Texture _texture, const GLenum _format, const GLuint _buffer)
+	{
+		glBindTexture(GL_TEXTURE_BUFFER, this->textures[_texture]);
+		glTexBuffer(GL_TEXTURE_BUFFER, _format, _buffer);
+		glBindTexture(GL_TEXTURE_BUFFER, 0);
+	}
+};
@@ -0,0 +1,93 @@
+#pragma once
+
+// GL Includes
+#include <GL/glew.h>
+
+// Measures the GPU time of the commands between Begin and End with a GL_TIME_ELAPSED query.
+// The result is only read once the GPU has it, so timing never stalls the frame; frames that start while
+// the previous query is still in flight are simply not sampled.
+class GpuTimer
+{
+public:
+	GpuTimer() : query(0), running(false), pending(false), samples(0), totalNanoseconds(0)
+	{
+	}
+
+	void Begin()
+	{
+		if (this->query == 0)
+		{
+			glGenQueries(1, &this->query);
+		}
+		this->Collect();
+		if (!this->pending)
+		{
+			glBeginQuery(GL_TIME_ELAPSED, this->query);
+			this->running = true;
+		}
+	}
+
+	void End()
+	{
+		if (this->running)
+		{
+			glEndQuery(GL_TIME_ELAPSED);
+			this->running = false;
+			this->pending = true;
+		}
+	}
+
+	// Once _samples measurements are in, stores their average in _averageMilliseconds, starts over and returns true
+	bool Average(const size_t _samples, double& _averageMilliseconds)
+	{
+		if (this->samples < _samples)
+		{
+			return false;
+		}
+		_averageMilliseconds = (double)this->totalNanoseconds / this->samples / 1.0e6;
+		this->Reset();
+		return true;
+	}
+
+	void Reset()
+	{
+		this->samples = 0;
+		this->totalNanoseconds = 0;
+	}
+
+	void Release()
+	{
+		if (this->query != 0)
+		{
+			glDeleteQueries(1, &this->query);
+			this->query = 0;
+		}
+		this->running = false;
+		this->pending = false;
+	}
+
+private:
+	GLuint query;
+	bool running;
+	bool pending;
+	size_t samples;
+	GLuint64 totalNanoseconds;
+
+	void Collect()
+	{
+		if (!this->pending)
+		{
+			return;
+		}
+		GLint available = 0;
+		glGetQueryObjectiv(this->query, GL_QUERY_RESULT_AVAILABLE, &available);
+		if (available)
+		{
+			GLuint64 nanoseconds = 0;
+			glGetQueryObjectui64v(this->query, GL_QUERY_RESULT, &nanoseconds);
+			this->totalNanoseconds += nanoseconds;
+			this->samples++;
+			this->pending = false;
+		}
+	}
+};
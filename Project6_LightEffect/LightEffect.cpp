@@ -1,5 +1,7 @@
 #include <iostream>
 #include <cmath>
+#include <chrono>
+#include <future>
 
 // GLEW
 #include <GL/glew.h>
@@ -15,6 +17,14 @@
 // Other includes
 #include "Shader.h"
 #include "Camera.h"
+#include "AssetLoader.h"
+#include "ProfileWatcher.h"
+#include "ProceduralLoft.h"
+#include "GpuTimer.h"
+#include "PackedVertex.h"
+#include "GpuNormals.h"
+#include "BladeDeflection.h"
+#include "StreamBuffer.h"
 
 
 // Function prototypes
@@ -22,12 +32,49 @@ void KeyCallback( GLFWwindow *window, int key, int scancode, int action, int mod
 void MouseCallback( GLFWwindow *window, double xPos, double yPos );
 void Draw(Shader& _lightingShader, Shader& _lampShader);
 void DoMovement();
+void UploadMesh(const std::vector<VertexAttribute>& _vVertex, const std::vector<GLuint>& _vIndices, GLuint& _VBO, GLuint& _EBO);
+void UploadIndices(const std::vector<GLuint>& _vIndices, GLuint& _EBO);
+void RefillMesh(const std::vector<VertexAttribute>& _vVertex, const std::vector<GLuint>& _vIndices, GLuint _VBO, GLuint _EBO);
+void SetupMeshVAO(GLuint& _VAO, GLuint _VBO, GLuint _EBO, GLuint _vp, GLuint _vn, GLuint _vs);
+void SetupMeshes(Shader& _lightingShader, GLuint _vp, GLuint _vn, GLuint _vs);
+void UpdateFoilReload(Shader& _lightingShader);
+void DrawFoilMesh(Shader& _lightingShader, bool _points, const glm::mat4& _modelView, const glm::mat4& _projection);
+void DrawHubMesh(Shader& _lightingShader, const glm::mat4& _modelView, const glm::mat4& _projection);
+void ReportFoilTimer(Shader& _lightingShader);
+void UpdatePackedMeshes(Shader& _lightingShader, GLuint _vp, GLuint _vn, GLuint _vs);
+void AttachDirtyBuffers(Shader& _lightingShader);
+void ApplyGeometryEdits(Shader& _lightingShader);
+void SetBladeStations(Shader& _lightingShader);
+void UpdateDeflection(Shader& _lightingShader, GLuint _vp, GLuint _vn);
+void SetBladeDeflection(Shader& _lightingShader, GLuint _blade);
+void ProcessFoil(std::vector<VertexAttribute>& _vVertex, std::vector<GLuint>& _vIndices, std::vector<GLuint>& _vStripIndices);
 
 // Window dimensions
 const GLuint WIDTH = 800, HEIGHT = 600;
 int SCREEN_WIDTH, SCREEN_HEIGHT;
 const GLuint FOILMAX = 10;
 const GLfloat HUBRADIUS = 3.0f;
+const GLfloat PROFILETOLERANCE = 2e-4f;	// Resampling error of the blade profile, about what the 501 file points already have
+
+// Blade profile: set NACACODE (e.g. "2412" or "23012") to generate it instead of reading foil_spline.out.
+// The generated profile is also the fallback when the file cannot be read.
+const char* NACACODE = nullptr;
+const char* NACAFALLBACK = "2412";
+const size_t NACAPOINTS = 501;
+const glm::vec2 NACATRAILINGEDGE = OUT_TRAILING_EDGE;	// Placed like foil_spline.out once loaded
+const glm::vec2 NACACHORD = OUT_CHORD;
+
+// Keep the blade profile as a B-spline of a few tens of control points and sample it per level of detail
+const bool USEPROFILESPLINE = true;
+const GLfloat SPLINETOLERANCE = 0.5f * PROFILETOLERANCE;	// Fit error, leaving the other half to the sampling
+const GLfloat SPLINESAMPLETOLERANCE = PROFILETOLERANCE - SPLINETOLERANCE;	// Sampling error of the profile from the spline
+const size_t SPLINECONTROLS = 64;
+
+// Root-to-tip blending: the base profile at the root, blended into these NACA sections further out the span
+const bool USESTATIONS = false;
+const char* STATIONCODES[] = { "2412", "0009" };
+const GLfloat STATIONSPAN[] = { 0.5f, 1.0f };
+const size_t STATIONPOINTS = 201;	// Corresponding points every station is resampled to
 
 // Camera
 Camera  camera( glm::vec3( 0.0f, 0.0f, 3.0f ) );
@@ -45,8 +92,116 @@ GLfloat lastFrame = 0.0f;  	// Time of last frame
 
 // VAO, VBO, EBO
 GLuint foilVAO, foilVBO, foilEBO;
+GLuint foilStripVAO, foilStripEBO;	// Shares foilVBO
 GLuint hubVAO, hubVBO, hubEBO;
+GLuint foilLodVAO, foilLodVBO, foilLodEBO;
+GLuint hubLodVAO, hubLodVBO, hubLodEBO;
 GLuint lampVAO, lampVBO;
+GLuint placeholderVAO;
+bool meshesReady = false;	// Set once the loader thread's foil and hub buffers are usable
+
+// Procedural foil: toggled with P, the blade is generated in core.vertexshader from the base profile alone.
+// It lofts the one profile like MakeFoil and takes its normals from the smooth loft surface, so it ignores
+// USESTATIONS and CREASENORMALS and shades differently from the indexed foil when either is on.
+ProceduralLoft proceduralFoil;
+bool useProceduralFoil = false;
+size_t indexedFoilBytes = 0;	// VBO + EBO bytes of the indexed foil, for comparison
+
+// Level of detail: toggled with L, each blade and the hub pick the coarsest level within LODPIXELERROR on screen
+const size_t LODLEVELS = 4;
+const GLfloat LODPIXELERROR = 1.0f;
+bool useLod = false;
+
+// Reorder the generated meshes for the post-transform vertex cache and vertex fetch after they are built
+const bool OPTIMIZEMESHES = true;
+
+// Recompute the foil normals from its faces after the weld, kept sharp where the faces turn by more than CREASEANGLE
+// degrees, so the trailing edge shades sharp without the loft's extra sections hiding it
+const bool CREASENORMALS = true;
+const GLfloat CREASEANGLE = 40.0f;
+const NormalWeight CREASEWEIGHT = NORMAL_WEIGHT_ANGLE;	// Also weights the deflection normals, on the CPU and the GPU
+
+// Merge coincident vertices of the generated meshes first and drop degenerate triangles. Without crease normals only
+// vertices whose normals agree within 60 degrees are merged, so the seam at the sharp trailing edge keeps its two
+// normals; with them the weld goes by position alone and the crease pass splits the seam again.
+const bool WELDMESHES = true;
+const GLfloat WELDEPSILON = 1e-5f;
+const GLfloat WELDNORMALCOSINE = CREASENORMALS ? -1.0f : 0.5f;
+
+// Index mode: toggled with I, the indexed foil is drawn as a triangle list or as strips with primitive restart.
+// The GPU time of the three blades is printed every FOILTIMERSAMPLES measured frames.
+bool useFoilStrips = false;
+GpuTimer foilTimer;
+const size_t FOILTIMERSAMPLES = 240;
+
+// Vertex format: cycled with V between the float layout and PackedMesh with 16-bit or 8-bit octahedral normals.
+// The packed copies are rebuilt on the render thread whenever the format or the foil changes.
+int packedNormalBits = 0;	// 0 = float layout
+bool packedMeshesDirty = false;
+PackedMesh foilPacked, hubPacked;
+GLuint foilPackedVAO, foilPackedVBO;	// Shares foilEBO and foilStripEBO
+GLuint hubPackedVAO, hubPackedVBO;	// Shares hubEBO
+
+// Geometry edits: -/= remove or add a blade section, [/] shrink or grow the hub. The foil and hub buffers are
+// edited in place and only the changed element ranges are uploaded. The weld, crease and cache passes renumber
+// every vertex and split the crease vertices, so sections cannot be appended to a foil they ran over: the first
+// section edit relofts the foil in loft order without them (one whole upload) and sets foilEditing, which keeps
+// them off for later edits and reloads. From then on adding a section uploads only the new sections and removing
+// one only the normals of the new tip. Section edits wait while a reload is in flight, since it lofts the
+// section count it started with.
+GLuint foilMax = FOILMAX;
+GLfloat hubRadius = HUBRADIUS;
+bool foilMaxChanged = false;
+bool hubRadiusChanged = false;
+bool foilEditing = false;
+DirtyBuffer<VertexAttribute> foilVertexBuffer, hubVertexBuffer;
+DirtyBuffer<GLuint> foilIndexBuffer, foilStripBuffer;
+
+// Deflection playback: toggled with B, the blades flap and twist every frame (aeroelastic playback). The deflected
+// positions are streamed every frame through foilStream, a persistent-mapped ring where ARB_buffer_storage is
+// available, so the upload never waits for the GPU. Their normals are recomputed on the GPU by transform feedback
+// (GpuNormals), so they are neither computed nor uploaded by the CPU; N switches to NormalEngine on the CPU for
+// comparison. Playback draws the float triangle list; the CPU and GPU frame times are printed every
+// FOILTIMERSAMPLES frames.
+bool playDeflection = false;
+bool useGpuNormals = true;
+bool deflectionDirty = true;	// The foil or the normal path changed: rebuild the adjacency and the VAO
+const GLfloat DEFLECTIONTIPBEND = 3.0f;
+const GLfloat DEFLECTIONTIPTWIST = 0.15f;	// Radians
+const GLfloat DEFLECTIONHERTZ = 1.0f;
+GpuNormals foilGpuNormals;
+NormalEngine foilTopology;
+StreamBuffer foilStream;
+GLuint foilDeflectVAO;	// Shares foilEBO
+std::vector<glm::vec3> vDeflectedPosition;	// CPU normal path
+std::vector<VertexAttribute> vDeflectedVertex;	// CPU normal path
+GpuTimer normalTimer;
+double deflectionCpuSeconds = 0.0;
+size_t deflectionFrames = 0;
+
+// Shader deflection: toggled with G, the same playback is evaluated in core.vertexshader from the span every vertex
+// got from its loft section, each blade a third of a period behind the one before. Per blade and frame only the
+// bend and twist coefficients are set as uniforms, and the static foil buffers (any index mode, LOD or packed
+// format) are drawn as they are. B and G switch each other off.
+bool useShaderDeflection = false;
+
+// Profile hot reload: the foil is rebuilt off the render thread whenever foil_spline.out is saved
+struct FoilRebuild
+{
+	std::vector<VertexAttribute> vProfile;
+	std::vector<VertexAttribute> vVertex;
+	std::vector<GLuint> vIndices;
+	std::vector<GLuint> vStripIndices;
+	LodChain foilLod;
+	SplineProfile spline;
+	LoftStations stations;
+	bool loaded;
+	bool processed;	// Run through ProcessFoil, so no longer in loft order
+	double buildSeconds;
+};
+ProfileWatcher profileWatcher;
+std::future<FoilRebuild> foilRebuild;
+std::chrono::steady_clock::time_point reloadStart;
 
 // The MAIN function, from here we start the application and run the game loop
 int main( )
@@ -96,51 +251,68 @@ int main( )
     
     // OpenGL options
     glEnable( GL_DEPTH_TEST );
+    glEnable( GL_PRIMITIVE_RESTART );
+    glPrimitiveRestartIndex( LoftEngine::RESTARTINDEX );
     
     // Build and compile shader programs
     Shader lightingShader("core.vertexshader", "core.fragmentshader");
     Shader lampShader( "lamp.vertexshader", "lamp.fragmentshader" );
+	useGpuNormals = foilGpuNormals.Load("normals.vertexshader");
+	foilTopology.SetThreadCount(0);
     
-	// Set up vertex data (and buffer(s)) and attribute pointers
-	lightingShader.LoadOutFile("foil_spline.out");
-	lightingShader.MakeFoil(FOILMAX);
-	lightingShader.MakeHub(HUBRADIUS);
-
-    // First, set the foil's VAO (and VBO)
-    glGenVertexArrays( 1, &foilVAO );
-    glGenBuffers( 1, &foilVBO);
-    glBindBuffer( GL_ARRAY_BUFFER, foilVBO);
-	glBufferData( GL_ARRAY_BUFFER, sizeof(VertexAttribute) * lightingShader.vFoilVertex.size(), &lightingShader.vFoilVertex.front(), GL_STATIC_DRAW);
-    glBindVertexArray( foilVAO );
-    // Position attribute
 	GLuint vp = glGetAttribLocation(lightingShader.Program, "position");
-	glEnableVertexAttribArray(vp);
-	glVertexAttribPointer(vp, 3, GL_FLOAT, GL_FALSE, sizeof(VertexAttribute), (GLvoid*)(0));    
-    // Normal attribute
 	GLuint vn = glGetAttribLocation(lightingShader.Program, "normal");
-	glEnableVertexAttribArray(vn);
-	glVertexAttribPointer(vn, 3, GL_FLOAT, GL_FALSE, sizeof(VertexAttribute), (GLvoid*) (3*sizeof(GLfloat)));
-	glGenBuffers(1, &foilEBO);
-	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, foilEBO);
-	glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(GLuint) * lightingShader.vFoilIndices.size(), &lightingShader.vFoilIndices.front(), GL_STATIC_DRAW);
-    glBindVertexArray( 0 );
+	GLuint vs = glGetAttribLocation(lightingShader.Program, "span");
 
-	// Second, set the hub's VAO (and VBO)
-	glGenVertexArrays(1, &hubVAO);
-	glGenBuffers(1, &hubVBO);
-	glBindBuffer(GL_ARRAY_BUFFER, hubVBO);
-	glBufferData(GL_ARRAY_BUFFER, sizeof(VertexAttribute) * lightingShader.vHubVertex.size(), &lightingShader.vHubVertex.front(), GL_STATIC_DRAW);
-	glBindVertexArray(hubVAO);
-	// Position attribute
-	glEnableVertexAttribArray(vp);
-	glVertexAttribPointer(vp, 3, GL_FLOAT, GL_FALSE, sizeof(VertexAttribute), (GLvoid*)(0));
-	// Normal attribute
-	glEnableVertexAttribArray(vn);
-	glVertexAttribPointer(vn, 3, GL_FLOAT, GL_FALSE, sizeof(VertexAttribute), (GLvoid*)(3 * sizeof(GLfloat)));
-	glGenBuffers(1, &hubEBO);
-	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, hubEBO);
-	glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(GLuint) * lightingShader.vHubIndices.size(), &lightingShader.vHubIndices.front(), GL_STATIC_DRAW);
-	glBindVertexArray(0);
+	// Set up vertex data (and buffer(s)) on a loader thread with a shared context, so the first frame is immediate
+	auto loadMeshes = [&lightingShader]()
+	{
+		if (nullptr != NACACODE)
+		{
+			lightingShader.LoadNacaProfile(NACACODE, NACAPOINTS, NACATRAILINGEDGE, NACACHORD);
+		}
+		else if (!lightingShader.LoadOutFile("foil_spline.out"))
+		{
+			lightingShader.LoadNacaProfile(NACAFALLBACK, NACAPOINTS, NACATRAILINGEDGE, NACACHORD);
+		}
+		if (USEPROFILESPLINE)
+		{
+			lightingShader.FitProfileSpline(SPLINETOLERANCE, SPLINECONTROLS);
+		}
+		lightingShader.ResampleProfile(USEPROFILESPLINE ? SPLINESAMPLETOLERANCE : PROFILETOLERANCE);
+		if (USESTATIONS)
+		{
+			SetBladeStations(lightingShader);
+		}
+		lightingShader.MakeFoil(FOILMAX);
+		lightingShader.MakeHub(HUBRADIUS);
+		lightingShader.MakeLod(FOILMAX, HUBRADIUS, PROFILETOLERANCE, LODLEVELS);
+		if (WELDMESHES)
+		{
+			lightingShader.WeldMeshes(WELDEPSILON, WELDNORMALCOSINE);
+		}
+		if (CREASENORMALS)
+		{
+			lightingShader.CreaseNormals(CREASEANGLE, CREASEWEIGHT);
+		}
+		if (OPTIMIZEMESHES)
+		{
+			lightingShader.OptimizeMeshes();
+		}
+		UploadMesh(lightingShader.vFoilVertex, lightingShader.vFoilIndices, foilVBO, foilEBO);
+		UploadIndices(lightingShader.vFoilStripIndices, foilStripEBO);
+		UploadMesh(lightingShader.vHubVertex, lightingShader.vHubIndices, hubVBO, hubEBO);
+		UploadMesh(lightingShader.foilLod.vVertex, lightingShader.foilLod.vIndices, foilLodVBO, foilLodEBO);
+		UploadMesh(lightingShader.hubLod.vVertex, lightingShader.hubLod.vIndices, hubLodVBO, hubLodEBO);
+	};
+	AssetLoader assetLoader;
+	profileWatcher.Watch("foil_spline.out");
+	if (!assetLoader.Start(window, loadMeshes))
+	{
+		// No shared context available: load synchronously as before
+		loadMeshes();
+		SetupMeshes(lightingShader, vp, vn, vs);
+	}
 
     // Then, set the light's VAO (VBO stays at location fixed. Also the vertices are the same for the 3D cube object)
     glGenVertexArrays( 1, &lampVAO);
@@ -153,6 +325,16 @@ int main( )
     glVertexAttribPointer( 0, 3, GL_FLOAT, GL_FALSE, 6 * sizeof( GLfloat ), ( GLvoid * )0 ); // Note that we skip over the normal vectors
     glEnableVertexAttribArray( 0 );
     glBindVertexArray( 0 );
+
+	// The same lit cube stands in for the propeller until the loader thread is done
+	glGenVertexArrays(1, &placeholderVAO);
+	glBindVertexArray(placeholderVAO);
+	glBindBuffer(GL_ARRAY_BUFFER, lampVBO);
+	glEnableVertexAttribArray(vp);
+	glVertexAttribPointer(vp, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(GLfloat), (GLvoid*)0);
+	glEnableVertexAttribArray(vn);
+	glVertexAttribPointer(vn, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(GLfloat), (GLvoid*)(3 * sizeof(GLfloat)));
+	glBindVertexArray(0);
         
     // Game loop
     while ( !glfwWindowShouldClose( window ) )
@@ -165,6 +347,28 @@ int main( )
         // Check if any events have been activiated (key pressed, mouse moved etc.) and call corresponding response functions
         glfwPollEvents( );
         DoMovement( );
+
+		// Pick up the meshes as soon as their upload has completed on the GPU
+		if (!meshesReady && assetLoader.Poll())
+		{
+			SetupMeshes(lightingShader, vp, vn, vs);
+		}
+		if (meshesReady)
+		{
+			UpdateFoilReload(lightingShader);
+		}
+		if (meshesReady && (foilMaxChanged || hubRadiusChanged))
+		{
+			ApplyGeometryEdits(lightingShader);
+		}
+		if (meshesReady && packedMeshesDirty)
+		{
+			UpdatePackedMeshes(lightingShader, vp, vn, vs);
+		}
+		if (meshesReady && playDeflection)
+		{
+			UpdateDeflection(lightingShader, vp, vn);
+		}
         
         // Clear the colorbuffer
         glClearColor( 0.1f, 0.1f, 0.1f, 1.0f );
@@ -172,19 +376,46 @@ int main( )
         
 		// Draw
 		Draw(lightingShader, lampShader);
+		if (meshesReady && playDeflection)
+		{
+			// The frame's last read of the streamed region has been issued
+			foilStream.Fence();
+		}
 
 		// Swap the screen buffers
 		glfwSwapBuffers(window);
 	}
     
+    // The loader thread may still be running if the window was closed early
+    assetLoader.Release( );
+    proceduralFoil.Release( );
+    foilTimer.Release( );
+    foilGpuNormals.Release( );
+    foilStream.Release( );
+    normalTimer.Release( );
+    
     glDeleteVertexArrays( 1, &foilVAO );
 	glDeleteBuffers(1, &foilVBO);
 	glDeleteBuffers(1, &foilEBO);
+	glDeleteVertexArrays(1, &foilStripVAO);
+	glDeleteBuffers(1, &foilStripEBO);
 	glDeleteVertexArrays(1, &hubVAO);
 	glDeleteBuffers(1, &hubVBO);
 	glDeleteBuffers(1, &hubEBO);
+	glDeleteVertexArrays(1, &foilLodVAO);
+	glDeleteBuffers(1, &foilLodVBO);
+	glDeleteBuffers(1, &foilLodEBO);
+	glDeleteVertexArrays(1, &hubLodVAO);
+	glDeleteBuffers(1, &hubLodVBO);
+	glDeleteBuffers(1, &hubLodEBO);
+	glDeleteVertexArrays(1, &foilPackedVAO);
+	glDeleteBuffers(1, &foilPackedVBO);
+	glDeleteVertexArrays(1, &hubPackedVAO);
+	glDeleteBuffers(1, &hubPackedVBO);
+	glDeleteVertexArrays(1, &foilDeflectVAO);
 	glDeleteVertexArrays( 1, &lampVAO);
 	glDeleteBuffers( 1, &lampVBO );
+	glDeleteVertexArrays(1, &placeholderVAO);
     
     // Terminate GLFW, clearing any resources allocated by GLFW.
     glfwTerminate( );
@@ -236,59 +467,84 @@ void Draw(Shader& _lightingShader, Shader& _lampShader)
 	glUniformMatrix4fv(viewLoc, 1, GL_FALSE, glm::value_ptr(view));
 	glUniformMatrix4fv(projLoc, 1, GL_FALSE, glm::value_ptr(projection));
 
-	// Draw foils (using foil's vertex attributes)
-	glBindVertexArray(foilVAO);
-	// foil #1.
 	glm::mat4 model;
-	model = glm::translate(model_pure, glm::vec3(HUBRADIUS, 0.0f, 0.0f));
-	glUniformMatrix4fv(modelLoc, 1, GL_FALSE, glm::value_ptr(model));
-	glDrawElements(GL_TRIANGLES, _lightingShader.vFoilIndices.size(), GL_UNSIGNED_INT, 0);
-	// foil #2.
-	model = glm::rotate(model_pure, 120 * 3.14f / 180, glm::vec3(0.0f, 0.0f, 1.0f));
-	model = glm::translate(model, glm::vec3(HUBRADIUS, 0.0f, 0.0f));
-	glUniformMatrix4fv(modelLoc, 1, GL_FALSE, glm::value_ptr(model));
-	glDrawElements(GL_TRIANGLES, _lightingShader.vFoilIndices.size(), GL_UNSIGNED_INT, 0);
-	// foil #3.
-	model = glm::rotate(model_pure, 240 * 3.14f / 180, glm::vec3(0.0f, 0.0f, 1.0f));
-	model = glm::translate(model, glm::vec3(HUBRADIUS, 0.0f, 0.0f));
-	glUniformMatrix4fv(modelLoc, 1, GL_FALSE, glm::value_ptr(model));
-	glDrawElements(GL_TRIANGLES, _lightingShader.vFoilIndices.size(), GL_UNSIGNED_INT, 0);
-	// foil #1's boundary line
-	glUniform3f(glGetUniformLocation(_lightingShader.Program, "material.ambient"), 1.0f, 1.0f, 1.0f);
-	glUniform3f(glGetUniformLocation(_lightingShader.Program, "material.diffuse"), 1.0f, 1.0f, 1.0f);
-	glUniform3f(glGetUniformLocation(_lightingShader.Program, "material.specular"), 1.0f, 1.0f, 1.0f);
-	glUniform1f(glGetUniformLocation(_lightingShader.Program, "material.shininess"), 32.0f);
-	model = glm::translate(model_pure, glm::vec3(HUBRADIUS, 0.0f, 0.0f));
-	glUniformMatrix4fv(modelLoc, 1, GL_FALSE, glm::value_ptr(model));
-	glDrawArrays(GL_POINTS, 0, _lightingShader.vFoilVertex.size());
-	// foil #2's boundary line
-	model = glm::rotate(model_pure, 120 * 3.14f / 180, glm::vec3(0.0f, 0.0f, 1.0f));
-	model = glm::translate(model, glm::vec3(HUBRADIUS, 0.0f, 0.0f));
-	glUniformMatrix4fv(modelLoc, 1, GL_FALSE, glm::value_ptr(model));
-	glDrawArrays(GL_POINTS, 0, _lightingShader.vFoilVertex.size());
-	// foil #3's boundary line
-	model = glm::rotate(model_pure, 240 * 3.14f / 180, glm::vec3(0.0f, 0.0f, 1.0f));
-	model = glm::translate(model, glm::vec3(HUBRADIUS, 0.0f, 0.0f));
-	glUniformMatrix4fv(modelLoc, 1, GL_FALSE, glm::value_ptr(model));
-	glDrawArrays(GL_POINTS, 0, _lightingShader.vFoilVertex.size());
-	glUniform3f(glGetUniformLocation(_lightingShader.Program, "material.ambient"), 1.0f, 0.5f, 0.31f);
-	glUniform3f(glGetUniformLocation(_lightingShader.Program, "material.diffuse"), 1.0f, 0.5f, 0.31f);
-	glUniform3f(glGetUniformLocation(_lightingShader.Program, "material.specular"), 0.5f, 0.5f, 0.5f);
-	glUniform1f(glGetUniformLocation(_lightingShader.Program, "material.shininess"), 32.0f);
-	glBindVertexArray(0);
+	if (!meshesReady)
+	{
+		// Draw the placeholder at the hub while the loader thread builds the meshes
+		model = glm::scale(model_pure, glm::vec3(2.0f * hubRadius));
+		glUniformMatrix4fv(modelLoc, 1, GL_FALSE, glm::value_ptr(model));
+		glBindVertexArray(placeholderVAO);
+		glDrawArrays(GL_TRIANGLES, 0, 36);
+		glBindVertexArray(0);
+	}
+	else
+	{
+		// Draw foils (using foil's vertex attributes)
+		glBindVertexArray(foilVAO);
+		foilTimer.Begin();
+		// foil #1.
+		model = glm::translate(model_pure, glm::vec3(hubRadius, 0.0f, 0.0f));
+		glUniformMatrix4fv(modelLoc, 1, GL_FALSE, glm::value_ptr(model));
+		SetBladeDeflection(_lightingShader, 0);
+		DrawFoilMesh(_lightingShader, false, view * model, projection);
+		// foil #2.
+		model = glm::rotate(model_pure, 120 * 3.14f / 180, glm::vec3(0.0f, 0.0f, 1.0f));
+		model = glm::translate(model, glm::vec3(hubRadius, 0.0f, 0.0f));
+		glUniformMatrix4fv(modelLoc, 1, GL_FALSE, glm::value_ptr(model));
+		SetBladeDeflection(_lightingShader, 1);
+		DrawFoilMesh(_lightingShader, false, view * model, projection);
+		// foil #3.
+		model = glm::rotate(model_pure, 240 * 3.14f / 180, glm::vec3(0.0f, 0.0f, 1.0f));
+		model = glm::translate(model, glm::vec3(hubRadius, 0.0f, 0.0f));
+		glUniformMatrix4fv(modelLoc, 1, GL_FALSE, glm::value_ptr(model));
+		SetBladeDeflection(_lightingShader, 2);
+		DrawFoilMesh(_lightingShader, false, view * model, projection);
+		foilTimer.End();
+		ReportFoilTimer(_lightingShader);
+		// foil #1's boundary line
+		glUniform3f(glGetUniformLocation(_lightingShader.Program, "material.ambient"), 1.0f, 1.0f, 1.0f);
+		glUniform3f(glGetUniformLocation(_lightingShader.Program, "material.diffuse"), 1.0f, 1.0f, 1.0f);
+		glUniform3f(glGetUniformLocation(_lightingShader.Program, "material.specular"), 1.0f, 1.0f, 1.0f);
+		glUniform1f(glGetUniformLocation(_lightingShader.Program, "material.shininess"), 32.0f);
+		model = glm::translate(model_pure, glm::vec3(hubRadius, 0.0f, 0.0f));
+		glUniformMatrix4fv(modelLoc, 1, GL_FALSE, glm::value_ptr(model));
+		SetBladeDeflection(_lightingShader, 0);
+		DrawFoilMesh(_lightingShader, true, view * model, projection);
+		// foil #2's boundary line
+		model = glm::rotate(model_pure, 120 * 3.14f / 180, glm::vec3(0.0f, 0.0f, 1.0f));
+		model = glm::translate(model, glm::vec3(hubRadius, 0.0f, 0.0f));
+		glUniformMatrix4fv(modelLoc, 1, GL_FALSE, glm::value_ptr(model));
+		SetBladeDeflection(_lightingShader, 1);
+		DrawFoilMesh(_lightingShader, true, view * model, projection);
+		// foil #3's boundary line
+		model = glm::rotate(model_pure, 240 * 3.14f / 180, glm::vec3(0.0f, 0.0f, 1.0f));
+		model = glm::translate(model, glm::vec3(hubRadius, 0.0f, 0.0f));
+		glUniformMatrix4fv(modelLoc, 1, GL_FALSE, glm::value_ptr(model));
+		SetBladeDeflection(_lightingShader, 2);
+		DrawFoilMesh(_lightingShader, true, view * model, projection);
+		if (useShaderDeflection)
+		{
+			glUniform1i(glGetUniformLocation(_lightingShader.Program, "deflect"), 0);
+		}
+		glUniform3f(glGetUniformLocation(_lightingShader.Program, "material.ambient"), 1.0f, 0.5f, 0.31f);
+		glUniform3f(glGetUniformLocation(_lightingShader.Program, "material.diffuse"), 1.0f, 0.5f, 0.31f);
+		glUniform3f(glGetUniformLocation(_lightingShader.Program, "material.specular"), 0.5f, 0.5f, 0.5f);
+		glUniform1f(glGetUniformLocation(_lightingShader.Program, "material.shininess"), 32.0f);
+		glBindVertexArray(0);
 
-	// Draw hub (using hub's vertex attributes)
-	glBindVertexArray(hubVAO);
-	glUniform3f(glGetUniformLocation(_lightingShader.Program, "material.ambient"), 0.5f, 0.5f, 0.5f);
-	glUniform3f(glGetUniformLocation(_lightingShader.Program, "material.diffuse"), 0.5f, 0.5f, 0.5f);
-	glUniform1f(glGetUniformLocation(_lightingShader.Program, "material.shininess"), 25.0f);
-	glUniformMatrix4fv(modelLoc, 1, GL_FALSE, glm::value_ptr(model_pure));
-	glDrawElements(GL_TRIANGLES, _lightingShader.vHubIndices.size(), GL_UNSIGNED_INT, 0);
-	glUniform3f(glGetUniformLocation(_lightingShader.Program, "material.ambient"), 1.0f, 0.5f, 0.31f);
-	glUniform3f(glGetUniformLocation(_lightingShader.Program, "material.diffuse"), 1.0f, 0.5f, 0.31f);
-	glUniform3f(glGetUniformLocation(_lightingShader.Program, "material.specular"), 0.5f, 0.5f, 0.5f);
-	glUniform1f(glGetUniformLocation(_lightingShader.Program, "material.shininess"), 32.0f);
-	glBindVertexArray(0);
+		// Draw hub (using hub's vertex attributes)
+		glBindVertexArray(hubVAO);
+		glUniform3f(glGetUniformLocation(_lightingShader.Program, "material.ambient"), 0.5f, 0.5f, 0.5f);
+		glUniform3f(glGetUniformLocation(_lightingShader.Program, "material.diffuse"), 0.5f, 0.5f, 0.5f);
+		glUniform1f(glGetUniformLocation(_lightingShader.Program, "material.shininess"), 25.0f);
+		glUniformMatrix4fv(modelLoc, 1, GL_FALSE, glm::value_ptr(model_pure));
+		DrawHubMesh(_lightingShader, view * model_pure, projection);
+		glUniform3f(glGetUniformLocation(_lightingShader.Program, "material.ambient"), 1.0f, 0.5f, 0.31f);
+		glUniform3f(glGetUniformLocation(_lightingShader.Program, "material.diffuse"), 1.0f, 0.5f, 0.31f);
+		glUniform3f(glGetUniformLocation(_lightingShader.Program, "material.specular"), 0.5f, 0.5f, 0.5f);
+		glUniform1f(glGetUniformLocation(_lightingShader.Program, "material.shininess"), 32.0f);
+		glBindVertexArray(0);
+	}
 
 	// Also set the lamp object, again binding the appropriate shader
 	glUseProgram(_lampShader.Program);
@@ -311,6 +567,394 @@ void Draw(Shader& _lightingShader, Shader& _lampShader)
 
 }
 
+// Uploads a mesh into new buffer objects. Runs on the loader thread, where no VAO is bound, so both buffers
+// are filled through GL_COPY_WRITE_BUFFER instead of touching the element array binding.
+void UploadMesh(const std::vector<VertexAttribute>& _vVertex, const std::vector<GLuint>& _vIndices, GLuint& _VBO, GLuint& _EBO)
+{
+	glGenBuffers(1, &_VBO);
+	glGenBuffers(1, &_EBO);
+	RefillMesh(_vVertex, _vIndices, _VBO, _EBO);
+}
+
+// Uploads an index buffer on its own, for another index mode over an existing VBO
+void UploadIndices(const std::vector<GLuint>& _vIndices, GLuint& _EBO)
+{
+	glGenBuffers(1, &_EBO);
+	glBindBuffer(GL_COPY_WRITE_BUFFER, _EBO);
+	glBufferData(GL_COPY_WRITE_BUFFER, sizeof(GLuint) * _vIndices.size(), _vIndices.data(), GL_STATIC_DRAW);
+	glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+}
+
+// Respecifies the storage of existing buffers with a new mesh
+void RefillMesh(const std::vector<VertexAttribute>& _vVertex, const std::vector<GLuint>& _vIndices, GLuint _VBO, GLuint _EBO)
+{
+	glBindBuffer(GL_COPY_WRITE_BUFFER, _VBO);
+	glBufferData(GL_COPY_WRITE_BUFFER, sizeof(VertexAttribute) * _vVertex.size(), _vVertex.data(), GL_STATIC_DRAW);
+	glBindBuffer(GL_COPY_WRITE_BUFFER, _EBO);
+	glBufferData(GL_COPY_WRITE_BUFFER, sizeof(GLuint) * _vIndices.size(), _vIndices.data(), GL_STATIC_DRAW);
+	glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+}
+
+// Builds a VAO for buffers uploaded by the loader thread (VAOs cannot be shared between contexts)
+void SetupMeshVAO(GLuint& _VAO, GLuint _VBO, GLuint _EBO, GLuint _vp, GLuint _vn, GLuint _vs)
+{
+	glGenVertexArrays(1, &_VAO);
+	glBindVertexArray(_VAO);
+	glBindBuffer(GL_ARRAY_BUFFER, _VBO);
+	// Position attribute
+	glEnableVertexAttribArray(_vp);
+	glVertexAttribPointer(_vp, 3, GL_FLOAT, GL_FALSE, sizeof(VertexAttribute), (GLvoid*)(0));
+	// Normal attribute
+	glEnableVertexAttribArray(_vn);
+	glVertexAttribPointer(_vn, 3, GL_FLOAT, GL_FALSE, sizeof(VertexAttribute), (GLvoid*)(3 * sizeof(GLfloat)));
+	// Span attribute
+	glEnableVertexAttribArray(_vs);
+	glVertexAttribPointer(_vs, 1, GL_FLOAT, GL_FALSE, sizeof(VertexAttribute), (GLvoid*)(6 * sizeof(GLfloat)));
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _EBO);
+	glBindVertexArray(0);
+}
+
+// Starts a foil rebuild when the profile changes and swaps it in once done. Only the foil buffers are
+// touched: the VBO is orphaned and refilled, and the EBO is only rewritten if the point count changed.
+void UpdateFoilReload(Shader& _lightingShader)
+{
+	if (foilRebuild.valid())
+	{
+		if (foilRebuild.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+		{
+			// Keep drawing the current foil while the rebuild runs
+			return;
+		}
+		FoilRebuild rebuild = foilRebuild.get();
+		if (!rebuild.loaded)
+		{
+			std::cout << "ERROR::RELOAD::PROFILE_NOT_LOADED, keeping the current foil" << std::endl;
+			return;
+		}
+
+		auto uploadStart = std::chrono::steady_clock::now();
+		size_t uploadedBytes = sizeof(VertexAttribute) * rebuild.vVertex.size();
+		glBindBuffer(GL_ARRAY_BUFFER, foilVBO);
+		if (rebuild.vVertex.size() == _lightingShader.vFoilVertex.size())
+		{
+			// Orphan the old storage so the driver does not wait for frames still reading it
+			glBufferData(GL_ARRAY_BUFFER, uploadedBytes, NULL, GL_STATIC_DRAW);
+			glBufferSubData(GL_ARRAY_BUFFER, 0, uploadedBytes, rebuild.vVertex.data());
+		}
+		else
+		{
+			glBufferData(GL_ARRAY_BUFFER, uploadedBytes, rebuild.vVertex.data(), GL_STATIC_DRAW);
+		}
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+		if (rebuild.vIndices != _lightingShader.vFoilIndices)
+		{
+			size_t indexBytes = sizeof(GLuint) * rebuild.vIndices.size();
+			glBindBuffer(GL_COPY_WRITE_BUFFER, foilEBO);
+			glBufferData(GL_COPY_WRITE_BUFFER, indexBytes, rebuild.vIndices.data(), GL_STATIC_DRAW);
+			glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+			uploadedBytes += indexBytes;
+		}
+		if (rebuild.vStripIndices != _lightingShader.vFoilStripIndices)
+		{
+			size_t indexBytes = sizeof(GLuint) * rebuild.vStripIndices.size();
+			glBindBuffer(GL_COPY_WRITE_BUFFER, foilStripEBO);
+			glBufferData(GL_COPY_WRITE_BUFFER, indexBytes, rebuild.vStripIndices.data(), GL_STATIC_DRAW);
+			glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+			uploadedBytes += indexBytes;
+		}
+		_lightingShader.vFoilVertex.swap(rebuild.vVertex);
+		_lightingShader.vFoilIndices.swap(rebuild.vIndices);
+		_lightingShader.vFoilStripIndices.swap(rebuild.vStripIndices);
+		proceduralFoil.Upload(rebuild.vProfile);
+		_lightingShader.SetProfile(rebuild.vProfile, rebuild.spline);
+		_lightingShader.foilStations = std::move(rebuild.stations);
+		_lightingShader.foilInLoftOrder = !rebuild.processed;
+		RefillMesh(rebuild.foilLod.vVertex, rebuild.foilLod.vIndices, foilLodVBO, foilLodEBO);
+		uploadedBytes += sizeof(VertexAttribute) * rebuild.foilLod.vVertex.size() + sizeof(GLuint) * rebuild.foilLod.vIndices.size();
+		_lightingShader.foilLod = std::move(rebuild.foilLod);
+		indexedFoilBytes = sizeof(VertexAttribute) * _lightingShader.vFoilVertex.size() + sizeof(GLuint) * _lightingShader.vFoilIndices.size();
+		packedMeshesDirty = (packedNormalBits != 0);
+		deflectionDirty = true;
+		AttachDirtyBuffers(_lightingShader);
+
+		auto now = std::chrono::steady_clock::now();
+		std::cout << "Profile reloaded: " << _lightingShader.vFoilVertex.size() << " vertices, "
+			<< "parse + loft " << rebuild.buildSeconds * 1000.0 << " ms, "
+			<< "upload " << std::chrono::duration<double, std::milli>(now - uploadStart).count() << " ms (" << uploadedBytes << " bytes), "
+			<< "latency " << std::chrono::duration<double, std::milli>(now - reloadStart).count() << " ms" << std::endl;
+		return;
+	}
+
+	if (profileWatcher.HasChanged())
+	{
+		reloadStart = std::chrono::steady_clock::now();
+		const GLuint sections = foilMax;
+		const LoftStations stations = _lightingShader.foilStations;
+		const bool process = !foilEditing && (WELDMESHES || CREASENORMALS || OPTIMIZEMESHES);
+		foilRebuild = std::async(std::launch::async, [sections, stations, process]()
+		{
+			auto buildStart = std::chrono::steady_clock::now();
+			FoilRebuild rebuild;
+			rebuild.processed = false;
+			std::vector<VertexAttribute> vProfile;
+			rebuild.loaded = LoadOutProfileCached("foil_spline.out", vProfile) && !vProfile.empty();
+			if (rebuild.loaded)
+			{
+				if (USEPROFILESPLINE)
+				{
+					rebuild.spline.Fit(vProfile, SPLINETOLERANCE, SPLINECONTROLS);
+					rebuild.spline.Sample(SPLINESAMPLETOLERANCE, rebuild.vProfile);
+				}
+				else
+				{
+					ResampleProfile(vProfile, PROFILETOLERANCE, rebuild.vProfile);
+				}
+				if (!stations.Empty())
+				{
+					// The reloaded profile replaces the root station; the others keep their points
+					rebuild.stations = stations;
+					ResampleCorresponding(rebuild.vProfile, stations.vProfile.front().size(), rebuild.stations.vProfile.front());
+					rebuild.vProfile = rebuild.stations.vProfile.front();
+					rebuild.spline.Clear();
+				}
+				const LoftStations* blend = rebuild.stations.Empty() ? nullptr : &rebuild.stations;
+				Shader::BuildFoil(rebuild.vProfile, sections, rebuild.vVertex, rebuild.vIndices, 1, blend);
+				LoftEngine::StripIndices(rebuild.vVertex.size() / rebuild.vProfile.size(), rebuild.vProfile.size(), rebuild.vStripIndices);
+				if (process)
+				{
+					ProcessFoil(rebuild.vVertex, rebuild.vIndices, rebuild.vStripIndices);
+					rebuild.processed = true;
+				}
+				Shader::BuildFoilLod(rebuild.vProfile, sections, PROFILETOLERANCE, LODLEVELS, rebuild.foilLod, rebuild.spline.Empty() ? nullptr : &rebuild.spline, blend);
+			}
+			rebuild.buildSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - buildStart).count();
+			return rebuild;
+		});
+	}
+}
+
+// Draws one blade (or its section points) from the foil VAO, procedurally from the profile in P mode,
+// or at the level its screen-space error allows in L mode
+void DrawFoilMesh(Shader& _lightingShader, bool _points, const glm::mat4& _modelView, const glm::mat4& _projection)
+{
+	if (useProceduralFoil)
+	{
+		proceduralFoil.Draw(_lightingShader.Program, foilMax, _points);
+		glBindVertexArray(foilVAO);
+	}
+	else if (useLod)
+	{
+		size_t level = _lightingShader.foilLod.SelectLevel(_modelView, _projection, (GLfloat)SCREEN_HEIGHT, LODPIXELERROR);
+		glBindVertexArray(foilLodVAO);
+		if (_points)
+		{
+			_lightingShader.foilLod.DrawPoints(level);
+		}
+		else
+		{
+			_lightingShader.foilLod.Draw(level);
+		}
+		glBindVertexArray(foilVAO);
+	}
+	else if (playDeflection && 0 != foilDeflectVAO)
+	{
+		glBindVertexArray(foilDeflectVAO);
+		if (_points)
+		{
+			glDrawArrays(GL_POINTS, 0, _lightingShader.vFoilVertex.size());
+		}
+		else
+		{
+			glDrawElements(GL_TRIANGLES, _lightingShader.vFoilIndices.size(), GL_UNSIGNED_INT, 0);
+		}
+		glBindVertexArray(foilVAO);
+	}
+	else
+	{
+		if (packedNormalBits != 0)
+		{
+			// The packed VAO serves both index modes, so its element buffer follows the current one
+			glBindVertexArray(foilPackedVAO);
+			glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, useFoilStrips ? foilStripEBO : foilEBO);
+			foilPacked.SetUniforms(_lightingShader.Program);
+		}
+		else if (useFoilStrips)
+		{
+			glBindVertexArray(foilStripVAO);
+		}
+
+		if (_points)
+		{
+			glDrawArrays(GL_POINTS, 0, _lightingShader.vFoilVertex.size());
+		}
+		else if (useFoilStrips)
+		{
+			glDrawElements(GL_TRIANGLE_STRIP, _lightingShader.vFoilStripIndices.size(), GL_UNSIGNED_INT, 0);
+		}
+		else
+		{
+			glDrawElements(GL_TRIANGLES, _lightingShader.vFoilIndices.size(), GL_UNSIGNED_INT, 0);
+		}
+
+		if (packedNormalBits != 0)
+		{
+			glUniform1i(glGetUniformLocation(_lightingShader.Program, "vertexFormat"), 0);
+		}
+		glBindVertexArray(foilVAO);
+	}
+}
+
+// Prints the averaged GPU time of the three blades with the current foil drawing mode
+void ReportFoilTimer(Shader& _lightingShader)
+{
+	double milliseconds;
+	if (!foilTimer.Average(FOILTIMERSAMPLES, milliseconds))
+	{
+		return;
+	}
+	if (useProceduralFoil || useLod)
+	{
+		std::cout << "Foil draw: " << milliseconds << " ms" << std::endl;
+		return;
+	}
+	size_t indexBytes = sizeof(GLuint) * (useFoilStrips ? _lightingShader.vFoilStripIndices.size() : _lightingShader.vFoilIndices.size());
+	size_t vertexBytes = (packedNormalBits != 0) ? foilPacked.vData.size() : sizeof(VertexAttribute) * _lightingShader.vFoilVertex.size();
+	std::cout << "Foil draw (" << (useFoilStrips ? "strips" : "list") << ", " << indexBytes << " index bytes, "
+		<< ((packedNormalBits != 0) ? "packed" : "float") << " vertices, " << vertexBytes << " vertex bytes): " << milliseconds << " ms" << std::endl;
+}
+
+// Packs the foil and hub in the current vertex format and points the packed VAOs at them
+void UpdatePackedMeshes(Shader& _lightingShader, GLuint _vp, GLuint _vn, GLuint _vs)
+{
+	packedMeshesDirty = false;
+	if (packedNormalBits == 0)
+	{
+		return;
+	}
+	if (0 == foilPackedVAO)
+	{
+		glGenVertexArrays(1, &foilPackedVAO);
+		glGenBuffers(1, &foilPackedVBO);
+		glGenVertexArrays(1, &hubPackedVAO);
+		glGenBuffers(1, &hubPackedVBO);
+	}
+
+	const PackedNormalBits bits = (packedNormalBits == 8) ? PACKED_NORMAL_8 : PACKED_NORMAL_16;
+	foilPacked.Pack(_lightingShader.vFoilVertex, bits);
+	foilPacked.Report("Foil", _lightingShader.vFoilVertex);
+	hubPacked.Pack(_lightingShader.vHubVertex, bits);
+	hubPacked.Report("Hub", _lightingShader.vHubVertex);
+
+	glBindVertexArray(foilPackedVAO);
+	glBindBuffer(GL_ARRAY_BUFFER, foilPackedVBO);
+	glBufferData(GL_ARRAY_BUFFER, foilPacked.vData.size(), foilPacked.vData.data(), GL_STATIC_DRAW);
+	foilPacked.SetupAttributes(_vp, _vn, _vs);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, foilEBO);
+	glBindVertexArray(hubPackedVAO);
+	glBindBuffer(GL_ARRAY_BUFFER, hubPackedVBO);
+	glBufferData(GL_ARRAY_BUFFER, hubPacked.vData.size(), hubPacked.vData.data(), GL_STATIC_DRAW);
+	hubPacked.SetupAttributes(_vp, _vn, _vs);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, hubEBO);
+	glBindVertexArray(0);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+// Builds the render thread's VAOs once the loader's buffers are usable
+void SetupMeshes(Shader& _lightingShader, GLuint _vp, GLuint _vn, GLuint _vs)
+{
+	SetupMeshVAO(foilVAO, foilVBO, foilEBO, _vp, _vn, _vs);
+	SetupMeshVAO(foilStripVAO, foilVBO, foilStripEBO, _vp, _vn, _vs);
+	SetupMeshVAO(hubVAO, hubVBO, hubEBO, _vp, _vn, _vs);
+	SetupMeshVAO(foilLodVAO, foilLodVBO, foilLodEBO, _vp, _vn, _vs);
+	SetupMeshVAO(hubLodVAO, hubLodVBO, hubLodEBO, _vp, _vn, _vs);
+	proceduralFoil.Upload(_lightingShader.GetProfile());
+	indexedFoilBytes = sizeof(VertexAttribute) * _lightingShader.vFoilVertex.size() + sizeof(GLuint) * _lightingShader.vFoilIndices.size();
+	AttachDirtyBuffers(_lightingShader);
+	meshesReady = true;
+}
+
+// Hands the current foil and hub buffers to the dirty-range uploaders, after they were (re)filled whole
+void AttachDirtyBuffers(Shader& _lightingShader)
+{
+	foilVertexBuffer.Attach(foilVBO, _lightingShader.vFoilVertex.size());
+	foilIndexBuffer.Attach(foilEBO, _lightingShader.vFoilIndices.size());
+	foilStripBuffer.Attach(foilStripEBO, _lightingShader.vFoilStripIndices.size());
+	hubVertexBuffer.Attach(hubVBO, _lightingShader.vHubVertex.size());
+}
+
+// Applies the section count and hub radius edits, uploading only what changed
+void ApplyGeometryEdits(Shader& _lightingShader)
+{
+	// A reload in flight was lofted with the section count it started with; the edit is applied to what it swaps in
+	if (foilMaxChanged && !foilRebuild.valid())
+	{
+		foilMaxChanged = false;
+		if (!foilEditing && !_lightingShader.foilInLoftOrder)
+		{
+			std::cout << "Foil edits: weld, crease and cache passes off, the foil is relofted once and later edits upload only what changed" << std::endl;
+		}
+		foilEditing = true;
+		DirtyRange vertices, indices, strips;
+		_lightingShader.ResizeFoil(foilMax, vertices, indices, strips);
+		foilVertexBuffer.Mark(vertices);
+		foilIndexBuffer.Mark(indices);
+		foilStripBuffer.Mark(strips);
+		size_t vertexBytes = foilVertexBuffer.Upload(_lightingShader.vFoilVertex);
+		size_t indexBytes = foilIndexBuffer.Upload(_lightingShader.vFoilIndices) + foilStripBuffer.Upload(_lightingShader.vFoilStripIndices);
+
+		// The level of detail chain depends on every section, so it is rebuilt whole
+		const SplineProfile* spline = _lightingShader.profileSpline.Empty() ? nullptr : &_lightingShader.profileSpline;
+		const LoftStations* stations = _lightingShader.foilStations.Empty() ? nullptr : &_lightingShader.foilStations;
+		Shader::BuildFoilLod(_lightingShader.GetProfile(), foilMax, PROFILETOLERANCE, LODLEVELS, _lightingShader.foilLod, spline, stations);
+		RefillMesh(_lightingShader.foilLod.vVertex, _lightingShader.foilLod.vIndices, foilLodVBO, foilLodEBO);
+		size_t lodBytes = sizeof(VertexAttribute) * _lightingShader.foilLod.vVertex.size() + sizeof(GLuint) * _lightingShader.foilLod.vIndices.size();
+
+		indexedFoilBytes = sizeof(VertexAttribute) * _lightingShader.vFoilVertex.size() + sizeof(GLuint) * _lightingShader.vFoilIndices.size();
+		packedMeshesDirty = (packedNormalBits != 0);
+		deflectionDirty = true;
+		std::cout << "FOILMAX " << foilMax << ": uploaded " << vertexBytes << " vertex bytes and " << indexBytes << " index bytes of "
+			<< indexedFoilBytes + sizeof(GLuint) * _lightingShader.vFoilStripIndices.size() << " (LOD chain " << lodBytes << " bytes)" << std::endl;
+	}
+	if (hubRadiusChanged)
+	{
+		hubRadiusChanged = false;
+		DirtyRange vertices;
+		_lightingShader.ResizeHub(hubRadius, vertices);
+		hubVertexBuffer.Mark(vertices);
+		size_t vertexBytes = hubVertexBuffer.Upload(_lightingShader.vHubVertex);
+
+		Shader::BuildHubLod(hubRadius, LODLEVELS, _lightingShader.hubLod);
+		RefillMesh(_lightingShader.hubLod.vVertex, _lightingShader.hubLod.vIndices, hubLodVBO, hubLodEBO);
+		size_t lodBytes = sizeof(VertexAttribute) * _lightingShader.hubLod.vVertex.size() + sizeof(GLuint) * _lightingShader.hubLod.vIndices.size();
+
+		packedMeshesDirty = (packedNormalBits != 0);
+		std::cout << "Hub radius " << hubRadius << ": uploaded " << vertexBytes << " vertex bytes, 0 index bytes (LOD chain " << lodBytes << " bytes)" << std::endl;
+	}
+}
+
+// Draws the hub, from its LOD chain in L mode
+void DrawHubMesh(Shader& _lightingShader, const glm::mat4& _modelView, const glm::mat4& _projection)
+{
+	if (useLod)
+	{
+		glBindVertexArray(hubLodVAO);
+		_lightingShader.hubLod.Draw(_lightingShader.hubLod.SelectLevel(_modelView, _projection, (GLfloat)SCREEN_HEIGHT, LODPIXELERROR));
+		glBindVertexArray(hubVAO);
+	}
+	else if (packedNormalBits != 0)
+	{
+		glBindVertexArray(hubPackedVAO);
+		hubPacked.SetUniforms(_lightingShader.Program);
+		glDrawElements(GL_TRIANGLES, _lightingShader.vHubIndices.size(), GL_UNSIGNED_INT, 0);
+		glUniform1i(glGetUniformLocation(_lightingShader.Program, "vertexFormat"), 0);
+		glBindVertexArray(hubVAO);
+	}
+	else
+	{
+		glDrawElements(GL_TRIANGLES, _lightingShader.vHubIndices.size(), GL_UNSIGNED_INT, 0);
+	}
+}
+
 // Moves/alters the camera positions based on user input
 void DoMovement()
 {
@@ -344,6 +988,101 @@ void KeyCallback( GLFWwindow *window, int key, int scancode, int action, int mod
         glfwSetWindowShouldClose(window, GL_TRUE);
     }
     
+	if (GLFW_KEY_EQUAL == key && GLFW_PRESS == action)
+	{
+		foilMax++;
+		foilMaxChanged = true;
+	}
+	if (GLFW_KEY_MINUS == key && GLFW_PRESS == action && foilMax > 1)
+	{
+		foilMax--;
+		foilMaxChanged = true;
+	}
+	if (GLFW_KEY_RIGHT_BRACKET == key && GLFW_PRESS == action)
+	{
+		hubRadius += 0.5f;
+		hubRadiusChanged = true;
+	}
+	if (GLFW_KEY_LEFT_BRACKET == key && GLFW_PRESS == action && hubRadius > 0.5f)
+	{
+		hubRadius -= 0.5f;
+		hubRadiusChanged = true;
+	}
+
+	if (GLFW_KEY_V == key && GLFW_PRESS == action)
+	{
+		// float -> 16-bit normals -> 8-bit normals -> float
+		packedNormalBits = (packedNormalBits == 0) ? 16 : ((packedNormalBits == 16) ? 8 : 0);
+		packedMeshesDirty = true;
+		foilTimer.Reset();
+		if (packedNormalBits == 0)
+		{
+			std::cout << "Vertex format: float" << std::endl;
+		}
+		else
+		{
+			std::cout << "Vertex format: packed, " << packedNormalBits << "-bit normals" << std::endl;
+		}
+	}
+
+	if (GLFW_KEY_I == key && GLFW_PRESS == action)
+	{
+		useFoilStrips = !useFoilStrips;
+		foilTimer.Reset();
+		std::cout << (useFoilStrips ? "Foil index mode: strips" : "Foil index mode: list") << std::endl;
+	}
+
+	if (GLFW_KEY_L == key && GLFW_PRESS == action)
+	{
+		useLod = !useLod;
+		foilTimer.Reset();
+		std::cout << (useLod ? "Level of detail on" : "Level of detail off") << std::endl;
+	}
+
+	if (GLFW_KEY_B == key && GLFW_PRESS == action)
+	{
+		playDeflection = !playDeflection;
+		useShaderDeflection = false;
+		foilTimer.Reset();
+		std::cout << (playDeflection ? "Deflection playback on" : "Deflection playback off") << std::endl;
+	}
+
+	if (GLFW_KEY_G == key && GLFW_PRESS == action)
+	{
+		useShaderDeflection = !useShaderDeflection;
+		playDeflection = false;
+		foilTimer.Reset();
+		if (useShaderDeflection)
+		{
+			std::cout << "Shader deflection on: " << 2 * BladeDeflection::TERMS << " coefficients (" << sizeof(BladeDeflection::bend) + sizeof(BladeDeflection::twist)
+				<< " bytes) per blade per frame, no vertex upload" << std::endl;
+		}
+		else
+		{
+			std::cout << "Shader deflection off" << std::endl;
+		}
+	}
+
+	if (GLFW_KEY_N == key && GLFW_PRESS == action)
+	{
+		useGpuNormals = !useGpuNormals;
+		deflectionDirty = true;
+		std::cout << (useGpuNormals ? "Deflection normals: GPU" : "Deflection normals: CPU") << std::endl;
+	}
+
+	if (GLFW_KEY_P == key && GLFW_PRESS == action)
+	{
+		useProceduralFoil = !useProceduralFoil;
+		foilTimer.Reset();
+		std::cout << (useProceduralFoil ? "Procedural foil: " : "Indexed foil: ")
+			<< (useProceduralFoil ? proceduralFoil.GetUploadedBytes() : indexedFoilBytes)
+			<< " bytes on the GPU" << std::endl;
+		if (useProceduralFoil && (USESTATIONS || CREASENORMALS))
+		{
+			std::cout << "Procedural foil: lofts the base profile with smooth normals, without the blade stations or crease normals" << std::endl;
+		}
+	}
+    
     if ( key >= 0 && key < 1024 )
     {
         if ( action == GLFW_PRESS )
@@ -374,3 +1113,157 @@ void MouseCallback( GLFWwindow *window, double xPos, double yPos )
     
     camera.ProcessMouseMovement( xOffset, yOffset );
 }
+
+// Makes the current base profile the root station of a blended blade, with the STATIONCODES sections further out
+void SetBladeStations(Shader& _lightingShader)
+{
+	std::vector<std::vector<VertexAttribute>> vProfile(1, _lightingShader.GetProfile());
+	std::vector<GLfloat> vSpan(1, 0.0f);
+	for (size_t i = 0; i < sizeof(STATIONCODES) / sizeof(STATIONCODES[0]); i++)
+	{
+		std::vector<VertexAttribute> vStation;
+		if (MakeNacaProfile(STATIONCODES[i], NACAPOINTS, vStation, NACATRAILINGEDGE, NACACHORD))
+		{
+			vProfile.push_back(vStation);
+			vSpan.push_back(STATIONSPAN[i]);
+		}
+	}
+	if (_lightingShader.SetStations(vProfile, vSpan, STATIONPOINTS))
+	{
+		std::cout << "Blade stations: " << vProfile.size() << " profiles of " << _lightingShader.GetProfile().size() << " points" << std::endl;
+	}
+}
+
+// Deflects the foil for this frame and streams it, with its normals recomputed on the GPU or on the CPU.
+// The adjacency, the stream buffer and the VAO are rebuilt first whenever the foil or the normal path changed;
+// after that the position (and CPU normal) attributes only move to the ring region of the frame.
+void UpdateDeflection(Shader& _lightingShader, GLuint _vp, GLuint _vn)
+{
+	const std::vector<VertexAttribute>& vRest = _lightingShader.vFoilVertex;
+	if (deflectionDirty)
+	{
+		deflectionDirty = false;
+		if (0 == foilDeflectVAO)
+		{
+			glGenVertexArrays(1, &foilDeflectVAO);
+		}
+		foilTopology.SetTopology(_lightingShader.vFoilIndices, vRest.size());
+		foilStream.Create(sizeof(VertexAttribute) * vRest.size());
+		if (useGpuNormals && !foilGpuNormals.SetMesh(foilStream.GetBuffer(), 3, foilEBO, foilTopology))
+		{
+			std::cout << "ERROR::DEFLECTION::GPU_NORMALS_UNAVAILABLE, using the CPU" << std::endl;
+			useGpuNormals = false;
+		}
+		glBindVertexArray(foilDeflectVAO);
+		glEnableVertexAttribArray(_vp);
+		if (useGpuNormals)
+		{
+			foilGpuNormals.BindAttribute(_vn);
+		}
+		else
+		{
+			glEnableVertexAttribArray(_vn);
+		}
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, foilEBO);
+		glBindVertexArray(0);
+		if (foilStream.IsPersistent())
+		{
+			std::cout << "Deflection stream: persistent-mapped ring of " << StreamBuffer::REGIONS << " regions" << std::endl;
+		}
+		else
+		{
+			std::cout << "Deflection stream: glBufferSubData into orphaned storage" << std::endl;
+		}
+		deflectionCpuSeconds = 0.0;
+		deflectionFrames = 0;
+		normalTimer.Reset();
+	}
+
+	auto start = std::chrono::steady_clock::now();
+	BladeDeflection deflection = BladeDeflection::Playback((GLfloat)glfwGetTime(), DEFLECTIONTIPBEND, DEFLECTIONTIPTWIST, DEFLECTIONHERTZ);
+	// GPU normals: the stream holds positions only and the normals come from the transform feedback buffer
+	const size_t stride = useGpuNormals ? sizeof(glm::vec3) : sizeof(VertexAttribute);
+	const size_t bytes = stride * vRest.size();
+	void* target = foilStream.Begin(bytes);
+	if (useGpuNormals)
+	{
+		DeflectPositions(vRest, deflection, foilMax, (glm::vec3*)target);
+	}
+	else
+	{
+		vDeflectedPosition.resize(vRest.size());
+		DeflectPositions(vRest, deflection, foilMax, vDeflectedPosition.data());
+		vDeflectedVertex.resize(vRest.size());
+		for (size_t v = 0; v < vRest.size(); v++)
+		{
+			vDeflectedVertex[v] = { vDeflectedPosition[v].x, vDeflectedPosition[v].y, vDeflectedPosition[v].z, vRest[v].normal, vRest[v].span };
+		}
+		foilTopology.Compute(vDeflectedVertex, _lightingShader.vFoilIndices, CREASEWEIGHT);
+		std::copy(vDeflectedVertex.begin(), vDeflectedVertex.end(), (VertexAttribute*)target);
+	}
+	const size_t offset = foilStream.End();
+
+	glBindVertexArray(foilDeflectVAO);
+	glBindBuffer(GL_ARRAY_BUFFER, foilStream.GetBuffer());
+	glVertexAttribPointer(_vp, 3, GL_FLOAT, GL_FALSE, (GLsizei)stride, (GLvoid*)offset);
+	if (!useGpuNormals)
+	{
+		glVertexAttribPointer(_vn, 3, GL_FLOAT, GL_FALSE, (GLsizei)stride, (GLvoid*)(offset + 3 * sizeof(GLfloat)));
+	}
+	glBindVertexArray(0);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	if (useGpuNormals)
+	{
+		normalTimer.Begin();
+		foilGpuNormals.Compute((GLint)(offset / sizeof(GLfloat)), CREASEWEIGHT);
+		normalTimer.End();
+	}
+	deflectionCpuSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	double gpuMilliseconds = 0.0;
+	if (++deflectionFrames == FOILTIMERSAMPLES)
+	{
+		bool gpuTimed = useGpuNormals && normalTimer.Average(1, gpuMilliseconds);
+		std::cout << "Deflection (" << (useGpuNormals ? "GPU" : "CPU") << " normals): " << deflectionCpuSeconds * 1000.0 / deflectionFrames
+			<< " ms CPU per frame, " << bytes << " bytes streamed per frame, " << foilStream.TakeStalls() << " stalled frames";
+		if (gpuTimed)
+		{
+			std::cout << ", normal pass " << gpuMilliseconds << " ms on the GPU";
+		}
+		std::cout << std::endl;
+		deflectionCpuSeconds = 0.0;
+		deflectionFrames = 0;
+		normalTimer.Reset();
+	}
+}
+
+// Sets the shader deflection of blade _blade (0, 1 or 2) for its next draws in G mode
+void SetBladeDeflection(Shader& _lightingShader, GLuint _blade)
+{
+	if (!useShaderDeflection)
+	{
+		return;
+	}
+	GLfloat time = (GLfloat)glfwGetTime() - (GLfloat)_blade / (3.0f * DEFLECTIONHERTZ);
+	BladeDeflection deflection = BladeDeflection::Playback(time, DEFLECTIONTIPBEND, DEFLECTIONTIPTWIST, DEFLECTIONHERTZ);
+	// Section k of the loft is at z = 2.5 k (the profile z is 1), so z grows by SectionZ(foilMax) per unit of s
+	deflection.SetUniforms(_lightingShader.Program, foilMax, LoftEngine::SectionZ(foilMax));
+}
+
+// Runs the weld, crease and cache passes that are switched on over a freshly lofted foil, keeping its strips in step,
+// so a foil rebuilt by a reload shades and draws like the one built at startup
+void ProcessFoil(std::vector<VertexAttribute>& _vVertex, std::vector<GLuint>& _vIndices, std::vector<GLuint>& _vStripIndices)
+{
+	if (WELDMESHES)
+	{
+		RemapIndices(_vStripIndices, WeldMesh("Foil", _vVertex, _vIndices, WELDEPSILON, WELDNORMALCOSINE), LoftEngine::RESTARTINDEX);
+	}
+	if (CREASENORMALS)
+	{
+		CreaseMesh("Foil", _vVertex, _vIndices, CREASEANGLE, CREASEWEIGHT, &_vStripIndices, LoftEngine::RESTARTINDEX);
+	}
+	if (OPTIMIZEMESHES)
+	{
+		RemapIndices(_vStripIndices, OptimizeMesh("Foil", _vVertex, _vIndices), LoftEngine::RESTARTINDEX);
+	}
+}
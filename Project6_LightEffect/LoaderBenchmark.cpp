@@ -0,0 +1,295 @@
+// Throughput benchmark of the .out profile loaders.
+// Usage: LoaderBenchmark [profile.out] [repeat]
+//        LoaderBenchmark <profile directory> [max threads]
+// Without a path a synthetic multi-million-point profile is written next to the binary first, and a synthetic
+// sweep file is then streamed section by section and checked against parsing each section on its own.
+// With a directory the batch ingest is timed on 1, 2, 4, ... worker threads.
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+
+// GLEW
+#include <GL/glew.h>
+
+// GLM
+#include <glm/glm.hpp>
+
+// Other includes
+#include "VertexAttribute.h"
+#include "AirfoilLoader.h"
+#include "AirfoilCache.h"
+#include "AirfoilDatabase.h"
+
+const size_t SYNTHETIC_POINTS = 2000000;
+const size_t SWEEP_SECTIONS = 64;
+const size_t SWEEP_POINTS = 20000;
+
+// The stringstream/split/stof loader Shader::LoadOutFile used before the mapped parser
+template <class Container>
+void Split(const std::string& str, Container& cont, char delim = '\n')
+{
+	std::stringstream ss(str);
+	std::string token;
+	while (std::getline(ss, token, delim)) {
+		cont.push_back(token);
+	}
+}
+
+bool LegacyLoadOutFile(const char * _filePath, std::vector<VertexAttribute>& vVertexT)
+{
+	std::ifstream vShaderFile(_filePath);
+	std::stringstream vShaderStream;
+	vShaderStream << vShaderFile.rdbuf();
+	std::string vertexCode = vShaderStream.str();
+
+	std::vector<std::string> vContainer;
+	Split(vertexCode, vContainer);
+
+	size_t verticesIndex = 0;
+	float firstX = 0.0f, firstY = 0.0f;
+	for (std::string var : vContainer)
+	{
+		std::vector<std::string> coorSet;
+		Split(var, coorSet, '\t');
+
+		if (coorSet.size() == 1)
+		{
+			if (verticesIndex != 0)
+			{
+				return false;
+			}
+			vVertexT.reserve(std::stoi(coorSet[0]));
+		}
+		else
+		{
+			if (verticesIndex == 0)
+			{
+				firstX = std::stof(coorSet[0]);
+				firstY = std::stof(coorSet[1]);
+			}
+			double x = std::stof(coorSet[0]) - firstX;
+			double y = std::stof(coorSet[1]) - firstY;
+			double z = 1.0f;
+
+			if (verticesIndex++ < vVertexT.capacity())
+			{
+				VertexAttribute vVA = { (GLfloat)x, (GLfloat)y, (GLfloat)z, glm::vec3(0.0f, 0.0f, 0.0f) };
+				vVertexT.push_back(vVA);
+			}
+		}
+	}
+	return true;
+}
+
+// Writes a closed, finely sampled profile in the same "%10.5f\t%10.5f" layout as foil_spline.out
+void WriteSyntheticProfile(const char *_filePath, size_t _points)
+{
+	FILE *file = std::fopen(_filePath, "w");
+	std::fprintf(file, "%zu\n", _points);
+	for (size_t i = 0; i < _points; i++)
+	{
+		double t = 2.0 * 3.14159265358979 * i / (_points - 1);
+		std::fprintf(file, "%10.5f\t%10.5f\n", 3.0 + 0.5 * (1.0 - std::cos(t)), 3.0 + 0.06 * std::sin(t));
+	}
+	std::fclose(file);
+}
+
+// Writes _sections profiles of _points points, section k thickened by 1 + 0.05 k, as one sweep file. The text of
+// every section is kept in _vText so it can be parsed on its own for comparison.
+void WriteSyntheticSweep(const char *_filePath, size_t _sections, size_t _points, std::vector<std::string>& _vText)
+{
+	FILE *file = std::fopen(_filePath, "w");
+	_vText.assign(_sections, std::string());
+	char line[64];
+	for (size_t k = 0; k < _sections; k++)
+	{
+		std::snprintf(line, sizeof(line), "%zu\n", _points);
+		_vText[k] += line;
+		for (size_t i = 0; i < _points; i++)
+		{
+			double t = 2.0 * 3.14159265358979 * i / (_points - 1);
+			std::snprintf(line, sizeof(line), "%10.5f\t%10.5f\n", 3.0 + 0.5 * (1.0 - std::cos(t)), 3.0 + 0.06 * (1.0 + 0.05 * k) * std::sin(t));
+			_vText[k] += line;
+		}
+		std::fputs(_vText[k].c_str(), file);
+	}
+	std::fclose(file);
+}
+
+template <class Loader>
+double TimeLoader(const char *_filePath, int _repeat, std::vector<VertexAttribute>& _vVertex, Loader _loader)
+{
+	double best = 1e30;
+	for (int i = 0; i < _repeat; i++)
+	{
+		_vVertex.clear();
+		_vVertex.shrink_to_fit();
+		auto start = std::chrono::steady_clock::now();
+		if (!_loader(_filePath, _vVertex))
+		{
+			std::cout << "ERROR::BENCHMARK::LOAD_FAILED" << std::endl;
+			std::exit(EXIT_FAILURE);
+		}
+		std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+		best = std::min(best, elapsed.count());
+	}
+	return best;
+}
+
+bool SamePoints(const std::vector<VertexAttribute>& _vA, const std::vector<VertexAttribute>& _vB)
+{
+	if (_vA.size() != _vB.size())
+	{
+		std::cout << "ERROR::BENCHMARK::POINT_COUNT_MISMATCH" << std::endl;
+		return false;
+	}
+	for (size_t i = 0; i < _vA.size(); i++)
+	{
+		if (_vA[i].x != _vB[i].x || _vA[i].y != _vB[i].y || _vA[i].z != _vB[i].z)
+		{
+			std::cout << "ERROR::BENCHMARK::POINT_MISMATCH at " << i << std::endl;
+			return false;
+		}
+	}
+	return true;
+}
+
+void Report(const char *_name, double _seconds, size_t _bytes, size_t _points)
+{
+	std::cout << _name << ": " << _seconds * 1000.0 << " ms, "
+		<< _bytes / _seconds / (1024.0 * 1024.0) << " MB/s, "
+		<< _points / _seconds / 1.0e6 << " Mpoints/s" << std::endl;
+}
+
+// Streams a synthetic sweep with ForEachOutSection, through a chunk shorter than one line (so lines straddle every
+// refill and the buffer has to grow) and through the default chunk. Every section must equal ParseOutProfile of
+// its own text.
+int BenchmarkSweep(const char *_filePath)
+{
+	std::vector<std::string> vText;
+	WriteSyntheticSweep(_filePath, SWEEP_SECTIONS, SWEEP_POINTS, vText);
+	MappedFile file;
+	if (!file.Open(_filePath))
+	{
+		return EXIT_FAILURE;
+	}
+	size_t bytes = file.GetSize();
+	file.Close();
+
+	std::vector<std::vector<VertexAttribute>> vExpected(vText.size());
+	for (size_t k = 0; k < vText.size(); k++)
+	{
+		ParseOutProfile(vText[k].data(), vText[k].data() + vText[k].size(), vExpected[k]);
+	}
+
+	const size_t chunkSizes[] = { 16, 1 << 20 };
+	for (size_t chunkSize : chunkSizes)
+	{
+		size_t sections = 0, points = 0;
+		bool same = true;
+		auto start = std::chrono::steady_clock::now();
+		bool read = ForEachOutSection(_filePath, [&](size_t _sectionIndex, std::vector<VertexAttribute>& _vSection)
+		{
+			sections++;
+			points += _vSection.size();
+			same = _sectionIndex < vExpected.size() && SamePoints(vExpected[_sectionIndex], _vSection);
+			return same;
+		}, chunkSize);
+		double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		if (!read || !same || sections != SWEEP_SECTIONS)
+		{
+			std::cout << "ERROR::BENCHMARK::SWEEP_MISMATCH with a " << chunkSize << " byte chunk after " << sections << " sections" << std::endl;
+			return EXIT_FAILURE;
+		}
+		std::cout << _filePath << " (" << sections << " sections, " << chunkSize << " byte chunk)";
+		Report("", seconds, bytes, points);
+	}
+	return EXIT_SUCCESS;
+}
+
+int BenchmarkDirectory(const char *_directory, unsigned _maxThreads)
+{
+	double singleSeconds = 0.0;
+	for (unsigned threads = 1; threads <= _maxThreads; threads *= 2)
+	{
+		AirfoilDatabase database;
+		if (!database.LoadDirectory(_directory, threads))
+		{
+			std::cout << "ERROR::BENCHMARK::LOAD_FAILED" << std::endl;
+		}
+		database.Report(std::cout, false);
+		if (threads == 1)
+		{
+			singleSeconds = database.GetTotalSeconds();
+		}
+		std::cout << "  scaling: " << singleSeconds / database.GetTotalSeconds() << "x" << std::endl;
+	}
+	return EXIT_SUCCESS;
+}
+
+int main(int argc, char *argv[])
+{
+	if (argc > 1 && std::filesystem::is_directory(argv[1]))
+	{
+		unsigned maxThreads = (argc > 2) ? std::atoi(argv[2]) : std::max(1u, std::thread::hardware_concurrency());
+		return BenchmarkDirectory(argv[1], maxThreads);
+	}
+
+	const char *filePath = "synthetic_spline.out";
+	if (argc > 1)
+	{
+		filePath = argv[1];
+	}
+	else
+	{
+		// Dated a minute back like a profile saved before the run, so its cache is not racy
+		WriteSyntheticProfile(filePath, SYNTHETIC_POINTS);
+		std::filesystem::last_write_time(filePath, std::filesystem::file_time_type::clock::now() - std::chrono::minutes(1));
+	}
+	int repeat = (argc > 2) ? std::atoi(argv[2]) : 3;
+
+	MappedFile file;
+	if (!file.Open(filePath))
+	{
+		return EXIT_FAILURE;
+	}
+	size_t bytes = file.GetSize();
+	file.Close();
+
+	std::vector<VertexAttribute> vLegacy, vMapped, vCached;
+	double legacySeconds = TimeLoader(filePath, repeat, vLegacy, LegacyLoadOutFile);
+	double mappedSeconds = TimeLoader(filePath, repeat, vMapped, LoadOutProfile);
+	// The first cached load converts the text; the timed ones map the binary cache. Stamping the cache with the
+	// source time makes it racy once, so that load hashes the source and restamps the cache.
+	double convertSeconds = TimeLoader(filePath, 1, vCached, LoadOutProfileCached);
+	double cachedSeconds = TimeLoader(filePath, repeat, vCached, LoadOutProfileCached);
+	std::string cachePath = GetAirfoilCachePath(filePath);
+	std::filesystem::last_write_time(cachePath, std::filesystem::last_write_time(filePath));
+	double racySeconds = TimeLoader(filePath, 1, vCached, LoadOutProfileCached);
+
+	if (!SamePoints(vLegacy, vMapped) || !SamePoints(vLegacy, vCached))
+	{
+		return EXIT_FAILURE;
+	}
+
+	std::cout << filePath << ": " << bytes << " bytes, " << vMapped.size() << " points" << std::endl;
+	Report("stringstream + stof", legacySeconds, bytes, vLegacy.size());
+	Report("mmap + from_chars  ", mappedSeconds, bytes, vMapped.size());
+	Report("convert to cache   ", convertSeconds, bytes, vCached.size());
+	Report("binary cache       ", cachedSeconds, bytes, vCached.size());
+	Report("racy binary cache  ", racySeconds, bytes, vCached.size());
+	std::cout << "speedup (parser): " << legacySeconds / mappedSeconds << "x" << std::endl;
+	std::cout << "speedup (cache):  " << legacySeconds / cachedSeconds << "x" << std::endl;
+
+	if (argc <= 1)
+	{
+		return BenchmarkSweep("synthetic_sweep.out");
+	}
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,182 @@
+// Benchmark of the blade loft: the original per-section copy loop of MakeFoil against LoftEngine.
+// Usage: LoftBenchmark [sections] [points] [repeat]
+// LoftEngine's time includes its analytic normals, which the original loop left to a separate CalculateNormal pass.
+// Then the same loft blending three station profiles from root to tip, after resampling them to correspond. The
+// stations are placed at different trailing edges and chord angles; every section must come out in the root's frame.
+#include <iostream>
+#include <vector>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+
+// GLEW
+#include <GL/glew.h>
+
+// GLM
+#include <glm/glm.hpp>
+
+// Other includes
+#include "VertexAttribute.h"
+#include "LoftEngine.h"
+#include "ProfileResampler.h"
+
+// The loft MakeFoil ran before LoftEngine: one temporary copy of the profile and one push_back per vertex and index
+void LegacyMakeFoil(const std::vector<VertexAttribute>& vVertexT, const GLuint _FOILMAX, std::vector<VertexAttribute>& vFoilVertex, std::vector<GLuint>& vFoilIndices)
+{
+	for (VertexAttribute var : vVertexT)
+	{
+		vFoilVertex.push_back(var);
+	}
+	for (size_t foilNum = 1; foilNum <= _FOILMAX; foilNum++)
+	{
+		std::vector<VertexAttribute> vVertexAttributeTheOtherZ = vVertexT;
+		for (VertexAttribute& var : vVertexAttributeTheOtherZ)
+		{
+			GLfloat factor = glm::log((GLfloat)foilNum + 2.5f);
+			var.x = var.x * factor;
+			var.y = var.y * factor;
+			var.z = var.z * 2.5f * foilNum;
+		}
+		for (VertexAttribute var : vVertexAttributeTheOtherZ)
+		{
+			vFoilVertex.push_back(var);
+		}
+		GLuint stride = vVertexAttributeTheOtherZ.size();
+		for (size_t ii = vFoilVertex.size() - 1; ii > vFoilVertex.size() - stride; ii--)
+		{
+			vFoilIndices.push_back((GLuint)ii);
+			vFoilIndices.push_back((GLuint)ii - 1);
+			vFoilIndices.push_back((GLuint)ii - 1 - stride);
+
+			vFoilIndices.push_back((GLuint)ii);
+			vFoilIndices.push_back((GLuint)ii - 1 - stride);
+			vFoilIndices.push_back((GLuint)ii - stride);
+		}
+	}
+}
+
+std::vector<VertexAttribute> MakeSyntheticProfile(size_t _points)
+{
+	std::vector<VertexAttribute> vProfile(_points);
+	for (size_t i = 0; i < _points; i++)
+	{
+		GLfloat t = 2.0f * 3.14159265f * i / (_points - 1);
+		vProfile[i] = { 0.5f * (1.0f - std::cos(t)), 0.06f * std::sin(t), 1.0f, glm::vec3(0.0f, 0.0f, 0.0f) };
+	}
+	return vProfile;
+}
+
+template <class Build>
+double TimeBest(int _repeat, Build _build)
+{
+	double best = 1e30;
+	for (int i = 0; i < _repeat; i++)
+	{
+		auto start = std::chrono::steady_clock::now();
+		_build();
+		best = std::min(best, std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+	}
+	return best;
+}
+
+int main(int argc, char *argv[])
+{
+	GLuint sections = (argc > 1) ? std::atoi(argv[1]) : 1000;
+	size_t points = (argc > 2) ? std::atoi(argv[2]) : 1000;
+	int repeat = (argc > 3) ? std::atoi(argv[3]) : 3;
+	std::vector<VertexAttribute> vProfile = MakeSyntheticProfile(points);
+
+	std::vector<VertexAttribute> vLegacyVertex, vLoftVertex;
+	std::vector<GLuint> vLegacyIndices;
+	double legacySeconds = TimeBest(repeat, [&]()
+	{
+		std::vector<VertexAttribute>().swap(vLegacyVertex);
+		std::vector<GLuint>().swap(vLegacyIndices);
+		LegacyMakeFoil(vProfile, sections, vLegacyVertex, vLegacyIndices);
+	});
+	LoftEngine loft;
+	double loftSeconds = TimeBest(repeat, [&]()
+	{
+		loft = LoftEngine();
+		loft.SetProfile(vProfile);
+		loft.Build(sections);
+	});
+	double interleaveSeconds = TimeBest(repeat, [&]()
+	{
+		std::vector<VertexAttribute>().swap(vLoftVertex);
+		loft.Interleave(vLoftVertex);
+	});
+
+	if (vLegacyIndices != loft.indices || vLegacyVertex.size() != vLoftVertex.size())
+	{
+		std::cout << "ERROR::BENCHMARK::INDEX_MISMATCH" << std::endl;
+		return EXIT_FAILURE;
+	}
+	for (size_t i = 0; i < vLegacyVertex.size(); i++)
+	{
+		if (vLegacyVertex[i].x != vLoftVertex[i].x || vLegacyVertex[i].y != vLoftVertex[i].y || vLegacyVertex[i].z != vLoftVertex[i].z)
+		{
+			std::cout << "ERROR::BENCHMARK::VERTEX_MISMATCH at " << i << std::endl;
+			return EXIT_FAILURE;
+		}
+	}
+
+	size_t vertexCount = loft.GetVertexCount();
+	std::cout << sections << " sections x " << points << " points: " << vertexCount << " vertices, " << loft.indices.size() << " indices" << std::endl;
+	std::cout << "MakeFoil (copy + push_back): " << legacySeconds * 1000.0 << " ms, " << vertexCount / legacySeconds / 1.0e6 << " Mvertices/s" << std::endl;
+	std::cout << "LoftEngine (SoA)           : " << loftSeconds * 1000.0 << " ms, " << vertexCount / loftSeconds / 1.0e6 << " Mvertices/s" << std::endl;
+	std::cout << "  + interleave for the VBO : " << interleaveSeconds * 1000.0 << " ms" << std::endl;
+	std::cout << "speedup: " << legacySeconds / loftSeconds << "x (" << legacySeconds / (loftSeconds + interleaveSeconds) << "x with interleave)" << std::endl;
+
+	// Root, mid and tip stations of different thickness, chord, trailing edge and chord angle
+	LoftStations stations;
+	stations.vSpan = { 0.0f, 0.5f, 1.0f };
+	const GLfloat thickness[] = { 1.5f, 1.0f, 0.5f };
+	const GLfloat chord[] = { 1.0f, 0.8f, 0.6f };
+	const glm::vec2 trailingEdge[] = { glm::vec2(0.0f, 0.0f), glm::vec2(3.0f, 3.0f), glm::vec2(-2.0f, 0.5f) };
+	const GLfloat angle[] = { 0.0f, 0.4f, -1.2f };
+	std::vector<std::vector<VertexAttribute>> vPlaced(3);
+	for (size_t i = 0; i < 3; i++)
+	{
+		vPlaced[i] = MakeSyntheticProfile(points + 2 * i);
+		for (VertexAttribute& var : vPlaced[i])
+		{
+			const GLfloat x = var.x * chord[i], y = var.y * chord[i] * thickness[i];
+			var.x = trailingEdge[i].x + std::cos(angle[i]) * x - std::sin(angle[i]) * y;
+			var.y = trailingEdge[i].y + std::sin(angle[i]) * x + std::cos(angle[i]) * y;
+		}
+	}
+	double correspondSeconds = TimeBest(repeat, [&]()
+	{
+		ResampleStations(vPlaced, points, stations.vProfile);
+	});
+	double blendSeconds = TimeBest(repeat, [&]()
+	{
+		loft = LoftEngine();
+		loft.SetStations(stations);
+		loft.Build(sections);
+	});
+	std::cout << "3 stations, " << loft.GetPointCount() << " corresponding points: resampling " << correspondSeconds * 1000.0 << " ms, blended loft "
+		<< blendSeconds * 1000.0 << " ms, " << loft.GetVertexCount() / blendSeconds / 1.0e6 << " Mvertices/s" << std::endl;
+
+	// The root has its trailing edge at the origin, which the section scale keeps, so every section must start at
+	// the origin with its chord along the root's
+	std::vector<VertexAttribute>().swap(vLoftVertex);
+	loft.Interleave(vLoftVertex);
+	const size_t stationPoints = loft.GetPointCount(), leading = stationPoints / 2;
+	const GLfloat rootAngle = std::atan2(vLoftVertex[leading].y, vLoftVertex[leading].x);
+	for (size_t section = 0; section * stationPoints < vLoftVertex.size(); section++)
+	{
+		const VertexAttribute& trailing = vLoftVertex[section * stationPoints];
+		const VertexAttribute& front = vLoftVertex[section * stationPoints + leading];
+		if (std::abs(trailing.x) > 1e-4f || std::abs(trailing.y) > 1e-4f || std::abs(std::atan2(front.y, front.x) - rootAngle) > 1e-4f)
+		{
+			std::cout << "ERROR::BENCHMARK::STATION_NOT_REGISTERED in section " << section << ": trailing edge (" << trailing.x << ", "
+				<< trailing.y << "), leading edge (" << front.x << ", " << front.y << ")" << std::endl;
+			return EXIT_FAILURE;
+		}
+	}
+	std::cout << "  stations registered: every section has its trailing edge at the origin and the root's chord angle" << std::endl;
+
+	return EXIT_SUCCESS;
+}
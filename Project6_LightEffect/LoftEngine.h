@@ -0,0 +1,300 @@
+#pragma once
+
+// Std. Includes
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <iostream>
+#include <vector>
+
+// GL Includes
+#include <GL/glew.h>
+
+// Other includes
+#include "VertexAttribute.h"
+
+// Lofts a base profile into the propeller blade: section 0 is the profile itself and section k = 1.._FOILMAX
+// is scaled by log(k + 2.5) and moved to z * 2.5 * k, connected by two triangles per profile segment.
+// A _sectionStep above 1 keeps only every step-th section (plus the tip), for coarser levels of detail.
+// The output size is known up front, so positions and indices are written into preallocated storage in one
+// pass. Positions are kept as structure of arrays (all x, then all y, then all z in one buffer) so the inner
+// loop over the profile points is a plain scale of contiguous floats that the compiler can vectorize.
+// Normals are written in the same pass, in closed form: the cross product of the profile tangent (central
+// differences of the base profile, scaled like the section) with the span direction towards the neighbouring
+// sections, which follows from the section transform alone. No triangle walk or averaging is needed.
+// SetStations replaces the single profile by several station profiles along the span; every section then lofts
+// the linear blend of the two stations around its span fraction foilNum / _FOILMAX.
+
+// Station profiles of a blade that changes airfoil from root to tip, see LoftEngine::SetStations
+struct LoftStations
+{
+	std::vector<std::vector<VertexAttribute>> vProfile;
+	std::vector<GLfloat> vSpan;	// Span fraction of each station, 0 = root, 1 = tip
+
+	bool Empty() const
+	{
+		return vProfile.empty();
+	}
+};
+
+class LoftEngine
+{
+public:
+	// Index that ends one strip and starts the next, set with glPrimitiveRestartIndex
+	static const GLuint RESTARTINDEX = 0xFFFFFFFFu;
+
+	std::vector<GLfloat> positions;
+	std::vector<GLfloat> normals;	// Same layout as positions
+	std::vector<GLuint> indices;
+
+	LoftEngine() : pointCount(0), sectionCount(0), sectionStep(1), foilMax(0), scaleOffset(2.5f), sectionSpacing(2.5f)
+	{
+	}
+
+	// Section law of the next Build: section k is scaled by log(k + _scaleOffset) and placed at z * _sectionSpacing * k.
+	// The defaults are the 2.5 / 2.5 MakeFoil has always used.
+	void SetLaw(const GLfloat _scaleOffset, const GLfloat _sectionSpacing)
+	{
+		this->scaleOffset = _scaleOffset;
+		this->sectionSpacing = _sectionSpacing;
+	}
+
+	void SetProfile(const std::vector<VertexAttribute>& _vProfile)
+	{
+		this->pointCount = _vProfile.size();
+		this->stations.resize(6 * this->pointCount);
+		this->stationSpan.assign(1, 0.0f);
+		this->StoreStation(0, _vProfile);
+	}
+
+	// Station profiles at increasing span fractions _vSpan (0 = root, 1 = tip). Every station needs the same
+	// point count with corresponding points at the same index, e.g. from ResampleCorresponding. Sections before
+	// the first or after the last station loft that station. Returns false and keeps the old profile otherwise.
+	bool SetStations(const LoftStations& _stations)
+	{
+		const std::vector<std::vector<VertexAttribute>>& _vProfile = _stations.vProfile;
+		const std::vector<GLfloat>& _vSpan = _stations.vSpan;
+		if (_vProfile.empty() || _vProfile.size() != _vSpan.size() || !std::is_sorted(_vSpan.begin(), _vSpan.end()))
+		{
+			std::cout << "ERROR::LOFT::INVALID_STATIONS" << std::endl;
+			return false;
+		}
+		for (const std::vector<VertexAttribute>& vProfile : _vProfile)
+		{
+			if (vProfile.size() != _vProfile.front().size())
+			{
+				std::cout << "ERROR::LOFT::STATION_SIZE_MISMATCH " << vProfile.size() << " != " << _vProfile.front().size() << std::endl;
+				return false;
+			}
+		}
+		this->pointCount = _vProfile.front().size();
+		this->stations.resize(6 * this->pointCount * _vProfile.size());
+		this->stationSpan = _vSpan;
+		for (size_t station = 0; station < _vProfile.size(); station++)
+		{
+			this->StoreStation(station, _vProfile[station]);
+		}
+		return true;
+	}
+
+	size_t GetStationCount() const
+	{
+		return this->stationSpan.size();
+	}
+
+	// Scale of section _foilNum, the glm::log((GLfloat)foilNum + 2.5f) factor MakeFoil has always used
+	static GLfloat SectionScale(size_t _foilNum, const GLfloat _scaleOffset = 2.5f)
+	{
+		return (_foilNum == 0) ? 1.0f : std::log((GLfloat)_foilNum + _scaleOffset);
+	}
+
+	// Factor on the profile z of section _foilNum: 1 for the base profile, 2.5 * k for section k
+	static GLfloat SectionZ(size_t _foilNum, const GLfloat _sectionSpacing = 2.5f)
+	{
+		return (_foilNum == 0) ? 1.0f : _sectionSpacing * (GLfloat)_foilNum;
+	}
+
+	// Sections before _firstSection (and the triangles between them) are not written, for callers that already
+	// hold them from a loft of the same profile and only need the sections from _firstSection on.
+	void Build(const GLuint _FOILMAX, const GLuint _sectionStep = 1, const size_t _firstSection = 0)
+	{
+		const size_t points = this->pointCount;
+		const size_t step = std::max<GLuint>(_sectionStep, 1);
+		this->sectionCount = ((size_t)_FOILMAX + step - 1) / step + 1;
+		this->sectionStep = step;
+		this->foilMax = _FOILMAX;
+		const size_t vertexCount = this->sectionCount * points;
+		this->positions.resize(3 * vertexCount);
+		this->normals.resize(3 * vertexCount);
+		this->indices.resize((points < 2) ? 0 : (this->sectionCount - 1) * (points - 1) * 6);
+
+		GLfloat *x = this->positions.data(), *y = x + vertexCount, *z = y + vertexCount;
+		GLfloat *nx = this->normals.data(), *ny = nx + vertexCount, *nz = ny + vertexCount;
+		GLuint *index = this->indices.data() + ((_firstSection == 0 || points < 2) ? 0 : (_firstSection - 1) * (points - 1) * 6);
+		for (size_t section = _firstSection; section < this->sectionCount; section++)
+		{
+			const size_t foilNum = std::min(section * step, (size_t)_FOILMAX);
+			const size_t base = section * points;
+			const GLfloat factor = SectionScale(foilNum, this->scaleOffset);
+			const GLfloat zFactor = SectionZ(foilNum, this->sectionSpacing);
+			const GLfloat *px = this->SectionProfile(foilNum, _FOILMAX, this->blend[0]), *py = px + points, *pz = py + points;
+			const GLfloat *tx = pz + points, *ty = tx + points, *tz = ty + points;
+			for (size_t i = 0; i < points; i++)
+			{
+				x[base + i] = px[i] * factor;
+				y[base + i] = py[i] * factor;
+				z[base + i] = pz[i] * zFactor;
+			}
+
+			// Span direction between the neighbouring sections of this loft (one-sided at the root and tip)
+			const size_t prevNum = (section == 0) ? foilNum : std::min((section - 1) * step, (size_t)_FOILMAX);
+			const size_t nextNum = (section + 1 == this->sectionCount) ? foilNum : std::min((section + 1) * step, (size_t)_FOILMAX);
+			const GLfloat prevScale = SectionScale(prevNum, this->scaleOffset), nextScale = SectionScale(nextNum, this->scaleOffset);
+			const GLfloat prevZ = SectionZ(prevNum, this->sectionSpacing), nextZ = SectionZ(nextNum, this->sectionSpacing);
+			const GLfloat *qx = this->SectionProfile(prevNum, _FOILMAX, this->blend[1]), *qy = qx + points, *qz = qy + points;
+			const GLfloat *rx = this->SectionProfile(nextNum, _FOILMAX, this->blend[2]), *ry = rx + points, *rz = ry + points;
+			for (size_t i = 0; i < points; i++)
+			{
+				const GLfloat ax = tx[i] * factor, ay = ty[i] * factor, az = tz[i] * zFactor;
+				const GLfloat bx = rx[i] * nextScale - qx[i] * prevScale, by = ry[i] * nextScale - qy[i] * prevScale, bz = rz[i] * nextZ - qz[i] * prevZ;
+				GLfloat cx = ay * bz - az * by, cy = az * bx - ax * bz, cz = ax * by - ay * bx;
+				GLfloat length = std::sqrt(cx * cx + cy * cy + cz * cz);
+				GLfloat scale = (length > 0.0f) ? 1.0f / length : 0.0f;
+				nx[base + i] = cx * scale;
+				ny[base + i] = cy * scale;
+				nz[base + i] = cz * scale;
+			}
+			if (section == 0)
+			{
+				continue;
+			}
+			// Same order as the original per-section loop: walk the section backwards, two triangles per segment
+			for (size_t ii = base + points - 1; ii > base; ii--)
+			{
+				*index++ = (GLuint)ii;
+				*index++ = (GLuint)(ii - 1);
+				*index++ = (GLuint)(ii - 1 - points);
+
+				*index++ = (GLuint)ii;
+				*index++ = (GLuint)(ii - 1 - points);
+				*index++ = (GLuint)(ii - points);
+			}
+		}
+	}
+
+	// Writes the same grid of _sectionCount sections by _points points as one GL_TRIANGLE_STRIP per section pair,
+	// the strips separated by RESTARTINDEX. Every quad is split along the same diagonal and with the same winding
+	// as the triangle list, at 2 indices per quad (plus one per strip) instead of 6.
+	static void StripIndices(const size_t _sectionCount, const size_t _points, std::vector<GLuint>& _vIndices)
+	{
+		_vIndices.clear();
+		if (_sectionCount < 2 || _points < 2)
+		{
+			return;
+		}
+		_vIndices.reserve((_sectionCount - 1) * (2 * _points + 1) - 1);
+		for (size_t section = 1; section < _sectionCount; section++)
+		{
+			if (section > 1)
+			{
+				_vIndices.push_back((GLuint)RESTARTINDEX);
+			}
+			const size_t base = section * _points;
+			for (size_t ii = base + _points; ii-- > base; )
+			{
+				_vIndices.push_back((GLuint)(ii - _points));
+				_vIndices.push_back((GLuint)ii);
+			}
+		}
+	}
+
+	// Writes the loft into the interleaved layout the VBOs use; vertices before _firstVertex are left as they are.
+	// Each vertex's span is the foilNum of its section, so it stays valid when sections are appended or dropped.
+	void Interleave(std::vector<VertexAttribute>& _vVertex, const size_t _firstVertex = 0) const
+	{
+		const size_t vertexCount = this->GetVertexCount();
+		const GLfloat *x = this->positions.data(), *y = x + vertexCount, *z = y + vertexCount;
+		const GLfloat *nx = this->normals.data(), *ny = nx + vertexCount, *nz = ny + vertexCount;
+		_vVertex.resize(vertexCount);
+		for (size_t i = _firstVertex; i < vertexCount; i++)
+		{
+			_vVertex[i].x = x[i];
+			_vVertex[i].y = y[i];
+			_vVertex[i].z = z[i];
+			_vVertex[i].normal = glm::vec3(nx[i], ny[i], nz[i]);
+			_vVertex[i].span = (GLfloat)std::min(i / this->pointCount * this->sectionStep, this->foilMax);
+		}
+	}
+
+	size_t GetPointCount() const
+	{
+		return this->pointCount;
+	}
+
+	size_t GetSectionCount() const
+	{
+		return this->sectionCount;
+	}
+
+	size_t GetVertexCount() const
+	{
+		return this->sectionCount * this->pointCount;
+	}
+
+private:
+	std::vector<GLfloat> stations;	// Per station x, y, z of the points, then their tangents, 6 * pointCount floats
+	std::vector<GLfloat> stationSpan;
+	std::vector<GLfloat> blend[3];	// Blended sections of the current, previous and next foilNum
+	size_t pointCount;
+	size_t sectionCount;
+	size_t sectionStep;	// Of the last Build
+	size_t foilMax;
+	GLfloat scaleOffset;
+	GLfloat sectionSpacing;
+
+	void StoreStation(const size_t _station, const std::vector<VertexAttribute>& _vProfile)
+	{
+		const size_t points = this->pointCount;
+		GLfloat *px = this->stations.data() + 6 * points * _station, *py = px + points, *pz = py + points;
+		GLfloat *tx = pz + points, *ty = tx + points, *tz = ty + points;
+		for (size_t i = 0; i < points; i++)
+		{
+			px[i] = _vProfile[i].x;
+			py[i] = _vProfile[i].y;
+			pz[i] = _vProfile[i].z;
+		}
+
+		// Central differences, one-sided at the ends of the profile
+		for (size_t i = 0; i < points; i++)
+		{
+			size_t next = std::min(i + 1, points - 1), prev = (i == 0) ? 0 : i - 1;
+			tx[i] = px[next] - px[prev];
+			ty[i] = py[next] - py[prev];
+			tz[i] = pz[next] - pz[prev];
+		}
+	}
+
+	// Points and tangents of section _foilNum before its scale: a station itself, or the blend of the two stations
+	// around its span fraction written to _scratch. Tangents blend like the points since both are linear in them.
+	const GLfloat* SectionProfile(const size_t _foilNum, const GLuint _FOILMAX, std::vector<GLfloat>& _scratch) const
+	{
+		const size_t stride = 6 * this->pointCount;
+		const size_t count = this->stationSpan.size();
+		const GLfloat span = (_FOILMAX == 0) ? 0.0f : (GLfloat)_foilNum / (GLfloat)_FOILMAX;
+		const size_t upper = std::upper_bound(this->stationSpan.begin(), this->stationSpan.end(), span) - this->stationSpan.begin();
+		if (upper == 0 || upper == count)
+		{
+			return this->stations.data() + stride * ((upper == 0) ? 0 : count - 1);
+		}
+		const size_t lower = upper - 1;
+		const GLfloat w = (span - this->stationSpan[lower]) / (this->stationSpan[upper] - this->stationSpan[lower]);
+		const GLfloat *a = this->stations.data() + stride * lower, *b = a + stride;
+		_scratch.resize(stride);
+		GLfloat *out = _scratch.data();
+		for (size_t i = 0; i < stride; i++)
+		{
+			out[i] = a[i] + w * (b[i] - a[i]);
+		}
+		return out;
+	}
+};
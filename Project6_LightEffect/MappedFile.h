@@ -0,0 +1,129 @@
+#pragma once
+
+// Std. Includes
+#include <cstddef>
+#include <iostream>
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// Read-only memory mapping of a whole file. The pages are faulted in by the OS on first touch,
+// so opening is O(1) and nothing is copied into the process heap.
+class MappedFile
+{
+public:
+	MappedFile() : data(nullptr), size(0)
+	{
+	}
+
+	~MappedFile()
+	{
+		this->Close();
+	}
+
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+	bool Open(const char *_filePath)
+	{
+		this->Close();
+#ifdef _WIN32
+		HANDLE file = CreateFileA(_filePath, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+		if (file == INVALID_HANDLE_VALUE)
+		{
+			std::cout << "ERROR::MAPPEDFILE::FILE_NOT_SUCCESFULLY_OPENED " << _filePath << std::endl;
+			return false;
+		}
+		LARGE_INTEGER fileSize;
+		if (!GetFileSizeEx(file, &fileSize))
+		{
+			std::cout << "ERROR::MAPPEDFILE::FILE_SIZE_NOT_READ " << _filePath << std::endl;
+			CloseHandle(file);
+			return false;
+		}
+		this->size = (size_t)fileSize.QuadPart;
+		if (this->size != 0)
+		{
+			HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+			if (mapping != NULL)
+			{
+				this->data = (const char *)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+				CloseHandle(mapping);
+			}
+		}
+		CloseHandle(file);
+#else
+		int file = open(_filePath, O_RDONLY);
+		if (file < 0)
+		{
+			std::cout << "ERROR::MAPPEDFILE::FILE_NOT_SUCCESFULLY_OPENED " << _filePath << std::endl;
+			return false;
+		}
+		struct stat fileStat;
+		if (fstat(file, &fileStat) != 0)
+		{
+			std::cout << "ERROR::MAPPEDFILE::FILE_SIZE_NOT_READ " << _filePath << std::endl;
+			close(file);
+			return false;
+		}
+		this->size = (size_t)fileStat.st_size;
+		if (this->size != 0)
+		{
+			void *view = mmap(nullptr, this->size, PROT_READ, MAP_PRIVATE, file, 0);
+			if (view != MAP_FAILED)
+			{
+				madvise(view, this->size, MADV_SEQUENTIAL);
+				this->data = (const char *)view;
+			}
+		}
+		close(file);
+#endif
+		if (this->size != 0 && this->data == nullptr)
+		{
+			std::cout << "ERROR::MAPPEDFILE::FILE_NOT_SUCCESFULLY_MAPPED " << _filePath << std::endl;
+			this->size = 0;
+			return false;
+		}
+		return true;
+	}
+
+	void Close()
+	{
+		if (this->data != nullptr)
+		{
+#ifdef _WIN32
+			UnmapViewOfFile(this->data);
+#else
+			munmap((void *)this->data, this->size);
+#endif
+		}
+		this->data = nullptr;
+		this->size = 0;
+	}
+
+	const char *GetData() const
+	{
+		return this->data;
+	}
+
+	size_t GetSize() const
+	{
+		return this->size;
+	}
+
+private:
+	const char *data;
+	size_t size;
+};
@@ -0,0 +1,105 @@
+#pragma once
+
+// Std. Includes
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+// GL Includes
+#include <GL/glew.h>
+
+#include <glm/glm.hpp>
+
+// Other includes
+#include "VertexAttribute.h"
+
+// One level of a LodChain: its range in the shared index buffer and the vertex its indices are relative to
+struct LodLevel
+{
+	size_t indexOffset;
+	GLsizei indexCount;
+	GLint baseVertex;
+	GLsizei vertexCount;
+	GLfloat geometricError;	// Largest distance from the full-resolution surface, in model units
+};
+
+// Levels of detail of one mesh, packed into a single vertex and index buffer so every level draws from the same
+// VAO with glDrawElementsBaseVertex. Level 0 is the full mesh; each following level is coarser.
+class LodChain
+{
+public:
+	std::vector<VertexAttribute> vVertex;
+	std::vector<GLuint> vIndices;
+	std::vector<LodLevel> vLevel;
+
+	void Clear()
+	{
+		vVertex.clear();
+		vIndices.clear();
+		vLevel.clear();
+	}
+
+	void AddLevel(const std::vector<VertexAttribute>& _vVertex, const std::vector<GLuint>& _vIndices, GLfloat _geometricError)
+	{
+		LodLevel level = { vIndices.size(), (GLsizei)_vIndices.size(), (GLint)vVertex.size(), (GLsizei)_vVertex.size(), _geometricError };
+		vVertex.insert(vVertex.end(), _vVertex.begin(), _vVertex.end());
+		vIndices.insert(vIndices.end(), _vIndices.begin(), _vIndices.end());
+		vLevel.push_back(level);
+
+		// Bounding sphere of the full mesh, used to find its distance to the camera
+		if (vLevel.size() == 1)
+		{
+			glm::vec3 lower(0.0f), upper(0.0f);
+			for (size_t i = 0; i < _vVertex.size(); i++)
+			{
+				glm::vec3 p(_vVertex[i].x, _vVertex[i].y, _vVertex[i].z);
+				lower = (i == 0) ? p : glm::min(lower, p);
+				upper = (i == 0) ? p : glm::max(upper, p);
+			}
+			this->center = 0.5f * (lower + upper);
+			this->radius = 0.5f * glm::length(upper - lower);
+		}
+	}
+
+	// Coarsest level whose geometric error projects to at most _pixelError pixels. _modelView takes the mesh
+	// into eye space (including any scale), _projection is the perspective matrix and _viewportHeight in pixels.
+	size_t SelectLevel(const glm::mat4& _modelView, const glm::mat4& _projection, GLfloat _viewportHeight, GLfloat _pixelError) const
+	{
+		if (vLevel.empty())
+		{
+			return 0;
+		}
+		glm::vec3 eyeCenter = glm::vec3(_modelView * glm::vec4(this->center, 1.0f));
+		GLfloat scale = std::max(glm::length(glm::vec3(_modelView[0])), std::max(glm::length(glm::vec3(_modelView[1])), glm::length(glm::vec3(_modelView[2]))));
+		// Nearest point of the bounding sphere; inside it every level has to be exact enough up close
+		GLfloat distance = std::max(glm::length(eyeCenter) - this->radius * scale, 1e-3f);
+		// Pixels per eye-space unit at that distance: projection[1][1] is cot(fovy / 2)
+		GLfloat pixelsPerUnit = _projection[1][1] * 0.5f * _viewportHeight / distance;
+
+		size_t selected = 0;
+		for (size_t level = 1; level < vLevel.size(); level++)
+		{
+			if (vLevel[level].geometricError * scale * pixelsPerUnit <= _pixelError)
+			{
+				selected = level;
+			}
+		}
+		return selected;
+	}
+
+	void Draw(size_t _level, GLenum _mode = GL_TRIANGLES) const
+	{
+		const LodLevel& level = vLevel[_level];
+		glDrawElementsBaseVertex(_mode, level.indexCount, GL_UNSIGNED_INT, (GLvoid*)(level.indexOffset * sizeof(GLuint)), level.baseVertex);
+	}
+
+	void DrawPoints(size_t _level) const
+	{
+		const LodLevel& level = vLevel[_level];
+		glDrawArrays(GL_POINTS, level.baseVertex, level.vertexCount);
+	}
+
+private:
+	glm::vec3 center;
+	GLfloat radius;
+};
@@ -0,0 +1,204 @@
+#pragma once
+
+// Std. Includes
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+// GL Includes
+#include <GL/glew.h>
+
+#include <glm/glm.hpp>
+
+// Other includes
+#include "VertexAttribute.h"
+
+// Where LoadOutFile puts foil_spline.out: the file starts and ends at its trailing edge (3, 3), which the loader
+// shifts to the origin, and its leading edge (7.146, 3.150) lands at the end of this chord
+const glm::vec2 OUT_TRAILING_EDGE(0.0f, 0.0f);
+const glm::vec2 OUT_CHORD(4.14598f, 0.14999f);
+
+// Mean line and thickness of a NACA 4-digit (MPTT) or 5-digit (LPSTT) section, in chord units
+struct NacaSection
+{
+	GLfloat thickness;	// Largest thickness
+	int series;	// 4 or 5
+	// 4-digit mean line
+	GLfloat camber;	// Largest camber
+	GLfloat camberPosition;
+	// 5-digit mean line
+	GLfloat r;
+	GLfloat k1;
+	GLfloat k2k1;	// k2 / k1 of the reflexed lines, 0 for the standard ones
+	GLfloat liftScale;	// Design lift coefficient / 0.3
+	bool reflex;
+};
+
+// Parses "2412", "0012", "23012", "23112", optionally prefixed with "NACA"
+inline bool ParseNacaCode(const char *_code, NacaSection& _section)
+{
+	if (std::strncmp(_code, "NACA", 4) == 0 || std::strncmp(_code, "naca", 4) == 0)
+	{
+		_code += 4;
+	}
+	while (*_code == ' ' || *_code == '-')
+	{
+		_code++;
+	}
+	size_t length = std::strlen(_code);
+	for (size_t i = 0; i < length; i++)
+	{
+		if (_code[i] < '0' || _code[i] > '9')
+		{
+			length = 0;
+		}
+	}
+	_section = NacaSection();
+	if (length == 4)
+	{
+		_section.series = 4;
+		_section.camber = (_code[0] - '0') / 100.0f;
+		_section.camberPosition = (_code[1] - '0') / 10.0f;
+		_section.thickness = ((_code[2] - '0') * 10 + (_code[3] - '0')) / 100.0f;
+		if (_section.camber > 0.0f && _section.camberPosition == 0.0f)
+		{
+			std::cout << "ERROR::NACA::CAMBER_POSITION_MISSING " << _code << std::endl;
+			return false;
+		}
+		return true;
+	}
+	if (length == 5)
+	{
+		// Mean line constants for camber positions 0.05 .. 0.25 (Abbott and von Doenhoff)
+		static const GLfloat STANDARD_R[5] = { 0.0580f, 0.1260f, 0.2025f, 0.2900f, 0.3910f };
+		static const GLfloat STANDARD_K1[5] = { 361.400f, 51.640f, 15.957f, 6.643f, 3.230f };
+		static const GLfloat REFLEX_R[5] = { 0.0f, 0.1300f, 0.2170f, 0.3180f, 0.4410f };
+		static const GLfloat REFLEX_K1[5] = { 0.0f, 51.990f, 15.793f, 6.520f, 3.191f };
+		static const GLfloat REFLEX_K2K1[5] = { 0.0f, 0.000764f, 0.00677f, 0.0303f, 0.1355f };
+
+		int position = _code[1] - '1';
+		_section.series = 5;
+		_section.reflex = (_code[2] == '1');
+		_section.thickness = ((_code[3] - '0') * 10 + (_code[4] - '0')) / 100.0f;
+		_section.liftScale = (_code[0] - '0') * 0.15f / 0.3f;
+		if (position < 0 || position > 4 || _code[2] > '1' || (_section.reflex && position == 0))
+		{
+			std::cout << "ERROR::NACA::UNSUPPORTED_MEAN_LINE " << _code << std::endl;
+			return false;
+		}
+		_section.r = _section.reflex ? REFLEX_R[position] : STANDARD_R[position];
+		_section.k1 = _section.reflex ? REFLEX_K1[position] : STANDARD_K1[position];
+		_section.k2k1 = _section.reflex ? REFLEX_K2K1[position] : 0.0f;
+		return true;
+	}
+	std::cout << "ERROR::NACA::INVALID_CODE " << _code << std::endl;
+	return false;
+}
+
+// Generates a NACA section as a closed profile with its trailing edge at _trailingEdge and its leading edge at
+// _trailingEdge + _chord, counter-clockwise (lower surface out, upper surface back) like foil_spline.out, z = 1, and
+// the first point repeated at the end. The defaults place it where the file's profile is once loaded, so the log
+// section scale about the origin lofts both the same way.
+// Chord stations use cosine spacing, which clusters points at both edges; an even _points is rounded up to the
+// next odd count so both surfaces share the leading edge point. The trailing edge is closed (-0.1036 thickness coefficient).
+// Stations are evaluated as structure of arrays in branch-free loops the compiler can vectorize.
+inline bool MakeNacaProfile(const char *_code, size_t _points, std::vector<VertexAttribute>& _vProfile,
+	const glm::vec2 _trailingEdge = OUT_TRAILING_EDGE, const glm::vec2 _chord = OUT_CHORD)
+{
+	NacaSection section;
+	if (!ParseNacaCode(_code, section))
+	{
+		return false;
+	}
+	const size_t stations = std::max<size_t>(_points / 2 + 1, 2);
+
+	// Chord stations from the trailing edge (x = 1) to the leading edge (x = 0)
+	std::vector<GLfloat> x(stations), yt(stations), yc(stations), slope(stations);
+	const GLfloat PI = 3.14159265358979f;
+	for (size_t i = 0; i < stations; i++)
+	{
+		x[i] = 0.5f * (1.0f + std::cos(PI * (GLfloat)i / (GLfloat)(stations - 1)));
+	}
+	x[stations - 1] = 0.0f;
+
+	const GLfloat t = section.thickness;
+	for (size_t i = 0; i < stations; i++)
+	{
+		const GLfloat xi = x[i];
+		yt[i] = 5.0f * t * (0.2969f * std::sqrt(xi) + xi * (-0.1260f + xi * (-0.3516f + xi * (0.2843f - 0.1036f * xi))));
+	}
+
+	if (section.series == 4)
+	{
+		const GLfloat m = section.camber, p = section.camberPosition;
+		const GLfloat front = (p > 0.0f) ? m / (p * p) : 0.0f;
+		const GLfloat back = (p < 1.0f) ? m / ((1.0f - p) * (1.0f - p)) : 0.0f;
+		for (size_t i = 0; i < stations; i++)
+		{
+			const GLfloat xi = x[i];
+			const GLfloat scale = (xi < p) ? front : back;
+			const GLfloat offset = (xi < p) ? 0.0f : 1.0f - 2.0f * p;
+			yc[i] = scale * (offset + 2.0f * p * xi - xi * xi);
+			slope[i] = 2.0f * scale * (p - xi);
+		}
+	}
+	else
+	{
+		const GLfloat r = section.r, k1 = section.k1, k2k1 = section.k2k1, lift = section.liftScale;
+		const GLfloat r3 = r * r * r, tail = (1.0f - r) * (1.0f - r) * (1.0f - r);
+		for (size_t i = 0; i < stations; i++)
+		{
+			const GLfloat xi = x[i];
+			if (!section.reflex)
+			{
+				yc[i] = (xi < r) ? k1 / 6.0f * (xi * xi * xi - 3.0f * r * xi * xi + r * r * (3.0f - r) * xi) : k1 * r3 / 6.0f * (1.0f - xi);
+				slope[i] = (xi < r) ? k1 / 6.0f * (3.0f * xi * xi - 6.0f * r * xi + r * r * (3.0f - r)) : -k1 * r3 / 6.0f;
+			}
+			else
+			{
+				const GLfloat d = xi - r;
+				const GLfloat lead = (xi < r) ? 1.0f : k2k1;
+				yc[i] = k1 / 6.0f * (lead * d * d * d - k2k1 * tail * xi - r3 * xi + r3);
+				slope[i] = k1 / 6.0f * (3.0f * lead * d * d - k2k1 * tail - r3);
+			}
+			yc[i] *= lift;
+			slope[i] *= lift;
+		}
+	}
+
+	// Offset the thickness normal to the mean line; sin and cos of its angle without calling atan
+	std::vector<GLfloat> ux(stations), uy(stations), lx(stations), ly(stations);
+	for (size_t i = 0; i < stations; i++)
+	{
+		const GLfloat inverse = 1.0f / std::sqrt(1.0f + slope[i] * slope[i]);
+		const GLfloat sine = slope[i] * inverse, cosine = inverse;
+		ux[i] = x[i] - yt[i] * sine;
+		uy[i] = yc[i] + yt[i] * cosine;
+		lx[i] = x[i] + yt[i] * sine;
+		ly[i] = yc[i] - yt[i] * cosine;
+	}
+
+	// Mirror the chord so it runs from the trailing edge to the leading edge, then map chord units onto _chord and its
+	// normal; lower surface to the leading edge, then the upper one back
+	const GLfloat teX = ux[0], teY = 0.5f * (uy[0] + ly[0]);
+	const glm::vec2 normal(-_chord.y, _chord.x);
+	_vProfile.clear();
+	_vProfile.reserve(2 * stations - 1);
+	for (size_t i = 0; i < stations; i++)
+	{
+		glm::vec2 p = _trailingEdge + (teX - lx[i]) * _chord + (ly[i] - teY) * normal;
+		VertexAttribute point = { p.x, p.y, 1.0f, glm::vec3(0.0f, 0.0f, 0.0f) };
+		_vProfile.push_back(point);
+	}
+	for (size_t i = stations - 1; i-- > 0; )
+	{
+		glm::vec2 p = _trailingEdge + (teX - ux[i]) * _chord + (uy[i] - teY) * normal;
+		VertexAttribute point = { p.x, p.y, 1.0f, glm::vec3(0.0f, 0.0f, 0.0f) };
+		_vProfile.push_back(point);
+	}
+	_vProfile.front().x = _vProfile.back().x = _trailingEdge.x;
+	_vProfile.front().y = _vProfile.back().y = _trailingEdge.y;
+	return true;
+}
@@ -0,0 +1,277 @@
+// Benchmark of the smooth vertex normals: the original serial CalculateNormal against NormalEngine.
+// Usage: NormalBenchmark [rings] [segments] [max threads]
+// The mesh is a closed torus of rings x segments vertices, so the exact normal of every vertex is known. The
+// original function keeps vertex numbers in a GLushort and renormalizes on every visit; past 65535 vertices its
+// normals land on the wrong vertices, which the error columns show. The speedup is given for the compute alone,
+// which is what a deforming mesh repeats every frame, and with the one-off adjacency build added.
+// Then the crease split: its cost on the smooth torus, and the error at the rims of a coarse closed cylinder,
+// smooth against split at 40 degrees. Last, a welded NACA blade is split with its strips, which must still draw
+// exactly the triangles of the list.
+#include <iostream>
+#include <vector>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <thread>
+
+// GLEW
+#include <GL/glew.h>
+
+// GLM
+#include <glm/glm.hpp>
+
+// Other includes
+#include "VertexAttribute.h"
+#include "NormalEngine.h"
+#include "LoftEngine.h"
+#include "NacaProfile.h"
+#include "VertexCache.h"
+#include "VertexWeld.h"
+
+// CalculateNormal as it was before NormalEngine
+void LegacyCalculateNormal(std::vector<VertexAttribute>& _vVertex, std::vector<GLuint>& _vIndices)
+{
+	std::vector<int> nbSeen;
+	nbSeen.resize(_vVertex.size(), 0);
+	for (int i = 0; i < _vIndices.size() - 2; i += 3) {
+		GLuint ia = _vIndices[i];
+		GLuint ib = _vIndices[i + 1];
+		GLuint ic = _vIndices[i + 2];
+		glm::vec3 normal = glm::normalize(glm::cross(
+			glm::vec3(_vVertex[ic].x, _vVertex[ic].y, _vVertex[ic].z) - glm::vec3(_vVertex[ib].x, _vVertex[ib].y, _vVertex[ib].z),
+			glm::vec3(_vVertex[ia].x, _vVertex[ia].y, _vVertex[ia].z) - glm::vec3(_vVertex[ib].x, _vVertex[ib].y, _vVertex[ib].z)));
+
+		int v[3];  v[0] = ia;  v[1] = ib;  v[2] = ic;
+		for (int j = 0; j < 3; j++) {
+			GLushort cur_v = v[j];
+			nbSeen[cur_v]++;
+			if (nbSeen[cur_v] == 1) {
+				_vVertex[cur_v].normal = normal;
+			}
+			else {
+				// The Method of Phong Shading
+				_vVertex[cur_v].normal.x = _vVertex[cur_v].normal.x * (1.0 - 1.0 / nbSeen[cur_v]) + normal.x * 1.0 / nbSeen[cur_v];
+				_vVertex[cur_v].normal.y = _vVertex[cur_v].normal.y * (1.0 - 1.0 / nbSeen[cur_v]) + normal.y * 1.0 / nbSeen[cur_v];
+				_vVertex[cur_v].normal.z = _vVertex[cur_v].normal.z * (1.0 - 1.0 / nbSeen[cur_v]) + normal.z * 1.0 / nbSeen[cur_v];
+				_vVertex[cur_v].normal = glm::normalize(_vVertex[cur_v].normal);
+			}
+		}
+	}
+}
+
+// Torus around z with tube radius 0.3; _vExact gets the analytic normals
+void MakeTorus(size_t _rings, size_t _segments, std::vector<VertexAttribute>& _vVertex, std::vector<GLuint>& _vIndices, std::vector<glm::vec3>& _vExact)
+{
+	const GLfloat PI = 3.14159265358979f, R = 1.0f, r = 0.3f;
+	_vVertex.resize(_rings * _segments);
+	_vExact.resize(_rings * _segments);
+	for (size_t i = 0; i < _rings; i++)
+	{
+		GLfloat u = 2.0f * PI * i / _rings;
+		for (size_t j = 0; j < _segments; j++)
+		{
+			GLfloat v = 2.0f * PI * j / _segments;
+			glm::vec3 normal(std::cos(u) * std::cos(v), std::sin(u) * std::cos(v), std::sin(v));
+			glm::vec3 center(R * std::cos(u), R * std::sin(u), 0.0f);
+			glm::vec3 p = center + r * normal;
+			_vVertex[i * _segments + j] = { p.x, p.y, p.z, glm::vec3(0.0f) };
+			_vExact[i * _segments + j] = normal;
+		}
+	}
+	_vIndices.clear();
+	_vIndices.reserve(6 * _rings * _segments);
+	for (size_t i = 0; i < _rings; i++)
+	{
+		for (size_t j = 0; j < _segments; j++)
+		{
+			GLuint a = (GLuint)(i * _segments + j), b = (GLuint)(((i + 1) % _rings) * _segments + j);
+			GLuint c = (GLuint)(((i + 1) % _rings) * _segments + (j + 1) % _segments), d = (GLuint)(i * _segments + (j + 1) % _segments);
+			_vIndices.insert(_vIndices.end(), { a, c, d, a, b, c });
+		}
+	}
+}
+
+// Largest and mean angle in degrees between the computed and the exact normals
+void MeasureError(const std::vector<VertexAttribute>& _vVertex, const std::vector<glm::vec3>& _vExact, double& _maxDegrees, double& _meanDegrees)
+{
+	_maxDegrees = 0.0;
+	_meanDegrees = 0.0;
+	for (size_t v = 0; v < _vVertex.size(); v++)
+	{
+		double degrees = glm::degrees(std::acos(glm::clamp((double)glm::dot(_vVertex[v].normal, _vExact[v]), -1.0, 1.0)));
+		_maxDegrees = std::max(_maxDegrees, degrees);
+		_meanDegrees += degrees / _vVertex.size();
+	}
+}
+
+// Closed cylinder around z of radius 1 from z = -1 to 1 with _segments sides. The rims are shared between the side
+// and the caps, as after a weld; _vCornerExact gets the exact surface normal at every face corner.
+void MakeCappedCylinder(size_t _segments, std::vector<VertexAttribute>& _vVertex, std::vector<GLuint>& _vIndices, std::vector<glm::vec3>& _vCornerExact)
+{
+	const GLfloat PI = 3.14159265358979f;
+	_vVertex.clear();
+	for (size_t i = 0; i < _segments; i++)
+	{
+		GLfloat u = 2.0f * PI * i / _segments;
+		_vVertex.push_back({ std::cos(u), std::sin(u), -1.0f, glm::vec3(0.0f) });
+		_vVertex.push_back({ std::cos(u), std::sin(u), 1.0f, glm::vec3(0.0f) });
+	}
+	const GLuint bottom = (GLuint)_vVertex.size(), top = bottom + 1;
+	_vVertex.push_back({ 0.0f, 0.0f, -1.0f, glm::vec3(0.0f) });
+	_vVertex.push_back({ 0.0f, 0.0f, 1.0f, glm::vec3(0.0f) });
+
+	_vIndices.clear();
+	_vCornerExact.clear();
+	for (size_t i = 0; i < _segments; i++)
+	{
+		GLuint a = (GLuint)(2 * i), b = (GLuint)(2 * ((i + 1) % _segments)), c = b + 1, d = a + 1;
+		for (GLuint v : { a, c, d, a, b, c })
+		{
+			_vIndices.push_back(v);
+			_vCornerExact.push_back(glm::vec3(_vVertex[v].x, _vVertex[v].y, 0.0f));
+		}
+		for (GLuint v : { bottom, b, a })
+		{
+			_vIndices.push_back(v);
+			_vCornerExact.push_back(glm::vec3(0.0f, 0.0f, -1.0f));
+		}
+		for (GLuint v : { top, d, c })
+		{
+			_vIndices.push_back(v);
+			_vCornerExact.push_back(glm::vec3(0.0f, 0.0f, 1.0f));
+		}
+	}
+}
+
+// Largest and mean angle in degrees between the normal every face corner is drawn with and the exact one
+void MeasureCornerError(const std::vector<VertexAttribute>& _vVertex, const std::vector<GLuint>& _vIndices, const std::vector<glm::vec3>& _vCornerExact, double& _maxDegrees, double& _meanDegrees)
+{
+	_maxDegrees = 0.0;
+	_meanDegrees = 0.0;
+	for (size_t k = 0; k < _vIndices.size(); k++)
+	{
+		double degrees = glm::degrees(std::acos(glm::clamp((double)glm::dot(_vVertex[_vIndices[k]].normal, _vCornerExact[k]), -1.0, 1.0)));
+		_maxDegrees = std::max(_maxDegrees, degrees);
+		_meanDegrees += degrees / _vIndices.size();
+	}
+}
+
+// Every triangle of a list or of strips joined by _restart, in drawing order and rotated to start at its smallest
+// index, sorted so two index buffers can be compared; strip triangles with two equal corners draw nothing
+std::vector<glm::uvec3> SortedTriangles(const std::vector<GLuint>& _vIndices, const bool _strips, const GLuint _restart)
+{
+	std::vector<glm::uvec3> vTriangle;
+	size_t stripBegin = 0;
+	for (size_t k = 0; k + 2 < _vIndices.size(); k += _strips ? 1 : 3)
+	{
+		glm::uvec3 t(_vIndices[k], _vIndices[k + 1], _vIndices[k + 2]);
+		if (_strips && t.x == _restart)
+		{
+			stripBegin = k + 1;
+			continue;
+		}
+		if (_strips && (t.y == _restart || t.z == _restart || t.x == t.y || t.y == t.z || t.x == t.z))
+		{
+			continue;
+		}
+		if (_strips && ((k - stripBegin) & 1) != 0)
+		{
+			std::swap(t.x, t.y);
+		}
+		while (t.x > t.y || t.x > t.z)
+		{
+			t = glm::uvec3(t.y, t.z, t.x);
+		}
+		vTriangle.push_back(t);
+	}
+	std::sort(vTriangle.begin(), vTriangle.end(), [](const glm::uvec3& _a, const glm::uvec3& _b)
+	{
+		return (_a.x != _b.x) ? _a.x < _b.x : (_a.y != _b.y) ? _a.y < _b.y : _a.z < _b.z;
+	});
+	return vTriangle;
+}
+
+int main(int argc, char *argv[])
+{
+	size_t rings = (argc > 1) ? std::atoi(argv[1]) : 2000;
+	size_t segments = (argc > 2) ? std::atoi(argv[2]) : 1000;
+	unsigned maxThreads = (argc > 3) ? std::atoi(argv[3]) : std::max(1u, std::thread::hardware_concurrency());
+
+	std::vector<VertexAttribute> vVertex;
+	std::vector<GLuint> vIndices;
+	std::vector<glm::vec3> vExact;
+	MakeTorus(rings, segments, vVertex, vIndices, vExact);
+	std::cout << vVertex.size() << " vertices, " << vIndices.size() / 3 << " triangles" << std::endl;
+
+	double maxDegrees, meanDegrees;
+	auto start = std::chrono::steady_clock::now();
+	LegacyCalculateNormal(vVertex, vIndices);
+	double legacySeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	MeasureError(vVertex, vExact, maxDegrees, meanDegrees);
+	std::cout << "CalculateNormal (serial) : " << legacySeconds * 1000.0 << " ms, error max " << maxDegrees << " mean " << meanDegrees << " degrees" << std::endl;
+
+	for (unsigned threads = 1; threads <= maxThreads; threads *= 2)
+	{
+		for (VertexAttribute& var : vVertex)
+		{
+			var.normal = glm::vec3(0.0f);
+		}
+		NormalEngine normals;
+		normals.SetThreadCount(threads);
+		normals.SetTopology(vIndices, vVertex.size());
+		normals.Compute(vVertex, vIndices);
+		MeasureError(vVertex, vExact, maxDegrees, meanDegrees);
+		std::cout << "NormalEngine (" << threads << " threads): " << normals.GetComputeSeconds() * 1000.0 << " ms + adjacency "
+			<< normals.GetTopologySeconds() * 1000.0 << " ms, error max " << maxDegrees << " mean " << meanDegrees << " degrees, "
+			<< legacySeconds / normals.GetComputeSeconds() << "x compute only, "
+			<< legacySeconds / (normals.GetComputeSeconds() + normals.GetTopologySeconds()) << "x with the adjacency" << std::endl;
+	}
+
+	NormalEngine creases;
+	creases.SetThreadCount(maxThreads);
+	CreaseResult result;
+	auto creaseStart = std::chrono::steady_clock::now();
+	creases.SplitCreases(vVertex, vIndices, std::cos(glm::radians(40.0f)), NORMAL_WEIGHT_ANGLE, result);
+	double creaseSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - creaseStart).count();
+	MeasureError(vVertex, vExact, maxDegrees, meanDegrees);
+	std::cout << "SplitCreases (" << maxThreads << " threads, angle weights): " << creaseSeconds * 1000.0 << " ms with adjacency and edge map, "
+		<< result.creaseEdges << " of " << result.edges << " edges creased, error max " << maxDegrees << " mean " << meanDegrees << " degrees" << std::endl;
+
+	std::vector<glm::vec3> vCornerExact;
+	for (size_t cylinderSegments : { 8, 36 })
+	{
+		MakeCappedCylinder(cylinderSegments, vVertex, vIndices, vCornerExact);
+		NormalEngine smooth;
+		smooth.Compute(vVertex, vIndices, NORMAL_WEIGHT_ANGLE);
+		MeasureCornerError(vVertex, vIndices, vCornerExact, maxDegrees, meanDegrees);
+		std::cout << cylinderSegments << "-sided closed cylinder, smooth: " << vVertex.size() << " vertices, error max " << maxDegrees << " mean " << meanDegrees << " degrees" << std::endl;
+		NormalEngine split;
+		split.SplitCreases(vVertex, vIndices, std::cos(glm::radians(40.0f)), NORMAL_WEIGHT_ANGLE, result);
+		MeasureCornerError(vVertex, vIndices, vCornerExact, maxDegrees, meanDegrees);
+		std::cout << cylinderSegments << "-sided closed cylinder, split: " << vVertex.size() << " vertices, error max " << maxDegrees << " mean " << meanDegrees << " degrees" << std::endl;
+	}
+
+	// The foil the viewer builds: a lofted NACA 2412 welded at its trailing edge, whose crease splits it again
+	std::vector<VertexAttribute> vProfile;
+	std::vector<GLuint> vStrips;
+	MakeNacaProfile("2412", 201, vProfile);
+	LoftEngine loft;
+	loft.SetProfile(vProfile);
+	loft.Build(10);
+	vVertex.clear();
+	loft.Interleave(vVertex);
+	vIndices = loft.indices;
+	LoftEngine::StripIndices(vVertex.size() / vProfile.size(), vProfile.size(), vStrips);
+	RemapIndices(vStrips, WeldMesh("Blade", vVertex, vIndices, 1e-5f), LoftEngine::RESTARTINDEX);
+	NormalEngine blade;
+	blade.SplitCreases(vVertex, vIndices, std::cos(glm::radians(40.0f)), NORMAL_WEIGHT_ANGLE, result, &vStrips, LoftEngine::RESTARTINDEX);
+	if (SortedTriangles(vIndices, false, LoftEngine::RESTARTINDEX) != SortedTriangles(vStrips, true, LoftEngine::RESTARTINDEX))
+	{
+		std::cout << "ERROR::BENCHMARK::STRIPS_DIFFER_FROM_LIST after the crease split" << std::endl;
+		return EXIT_FAILURE;
+	}
+	std::cout << "Blade crease split: " << result.outputVertices - result.inputVertices << " vertices split off, " << vIndices.size() << " list and "
+		<< vStrips.size() << " strip indices draw the same triangles" << std::endl;
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,688 @@
+#pragma once
+
+// Std. Includes
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+// GL Includes
+#include <GL/glew.h>
+
+#include <glm/glm.hpp>
+
+// Other includes
+#include "VertexAttribute.h"
+
+// How the faces around a vertex contribute to its normal
+enum NormalWeight
+{
+	NORMAL_WEIGHT_UNIT = 0,	// Every face counts the same, the average CalculateNormal takes
+	NORMAL_WEIGHT_AREA = 1,	// Faces count with their area
+	NORMAL_WEIGHT_ANGLE = 2	// Faces count with their corner angle at the vertex, which does not depend on how a surface is split into triangles
+};
+
+// What a SplitCreases pass did
+struct CreaseResult
+{
+	size_t inputVertices;
+	size_t outputVertices;
+	size_t edges;
+	size_t creaseEdges;	// Faces turning by more than the crease angle, or an edge not shared by exactly two faces
+};
+
+// The edges of a triangle list in a hash table keyed on their two vertex numbers, each with the faces on it.
+// Open addressing with one insertion per face corner, so it builds in O(n). Every vertex owns a run of slots for the
+// edges to its higher-numbered neighbours, and the run starts at a position proportional to its number, so walking
+// the faces of a mesh whose vertex numbers are local (as after OptimizeMesh or a loft) walks the table in order too.
+// Fibonacci hashing, as in WeldGrid, took 6 times longer to look up every edge of a 2M-vertex mesh.
+class EdgeMap
+{
+public:
+	static const GLuint NOFACE = 0xFFFFFFFFu;
+	static const GLuint MANYFACES = 0xFFFFFFFEu;	// More than two faces on the edge
+
+	void Build(const std::vector<GLuint>& _vIndices, const size_t _vertexCount)
+	{
+		const size_t faceCount = _vIndices.size() / 3;
+		size_t slots = 16;
+		while (slots < 3 * faceCount)
+		{
+			slots *= 2;
+		}
+		this->runShift = 0;
+		while ((std::max<size_t>(_vertexCount, 1) << (this->runShift + 1)) <= slots)
+		{
+			this->runShift++;
+		}
+		this->vKey.assign(slots, (uint64_t)EMPTYKEY);
+		this->vFace0.assign(slots, (GLuint)NOFACE);
+		this->vFace1.assign(slots, (GLuint)NOFACE);
+		this->vFaceEdge.resize(3 * faceCount);
+		this->edgeCount = 0;
+		for (size_t f = 0; f < faceCount; f++)
+		{
+			for (size_t c = 0; c < 3; c++)
+			{
+				const uint64_t key = Key(_vIndices[3 * f + c], _vIndices[3 * f + (c + 1) % 3]);
+				size_t slot = this->Find(key);
+				this->vFaceEdge[3 * f + c] = (GLuint)slot;
+				if (this->vKey[slot] == EMPTYKEY)
+				{
+					this->vKey[slot] = key;
+					this->vFace0[slot] = (GLuint)f;
+					this->edgeCount++;
+				}
+				else
+				{
+					this->vFace1[slot] = (this->vFace1[slot] == NOFACE) ? (GLuint)f : (GLuint)MANYFACES;
+				}
+			}
+		}
+	}
+
+	// The face on the other side of edge _edge of _face (the edge from its corner _edge to the next corner):
+	// NOFACE on a border, MANYFACES on a non-manifold edge. Reads the slot Build found, without hashing again.
+	GLuint Across(const GLuint _face, const size_t _edge) const
+	{
+		const size_t slot = this->vFaceEdge[3 * (size_t)_face + _edge];
+		if (this->vFace1[slot] >= MANYFACES)
+		{
+			return this->vFace1[slot];
+		}
+		return (this->vFace0[slot] == _face) ? this->vFace1[slot] : this->vFace0[slot];
+	}
+
+	// Calls _visit(face0, face1) for every edge, face1 being NOFACE or MANYFACES where there is no single other face
+	template <class Visit>
+	void ForEachEdge(Visit _visit) const
+	{
+		for (size_t slot = 0; slot < this->vKey.size(); slot++)
+		{
+			if (this->vKey[slot] != EMPTYKEY)
+			{
+				_visit(this->vFace0[slot], this->vFace1[slot]);
+			}
+		}
+	}
+
+	size_t GetEdgeCount() const
+	{
+		return this->edgeCount;
+	}
+
+private:
+	static const uint64_t EMPTYKEY = ~(uint64_t)0;
+
+	int runShift;	// log2 of the slots per vertex
+	size_t edgeCount;
+	std::vector<uint64_t> vKey;
+	std::vector<GLuint> vFace0;
+	std::vector<GLuint> vFace1;
+	std::vector<GLuint> vFaceEdge;	// Slot of edge e of face f at 3 * f + e
+
+	// Both directions of an edge get the same key
+	static uint64_t Key(const GLuint _a, const GLuint _b)
+	{
+		return (_a < _b) ? (((uint64_t)_a << 32) | _b) : (((uint64_t)_b << 32) | _a);
+	}
+
+	// Starts in the run of the lower vertex, at a slot picked by the low bits of the higher one
+	size_t Find(const uint64_t _key) const
+	{
+		const size_t mask = this->vKey.size() - 1;
+		const size_t run = ((size_t)1 << this->runShift) - 1;
+		size_t slot = ((((size_t)(_key >> 32)) << this->runShift) | ((size_t)_key & run)) & mask;
+		while (this->vKey[slot] != EMPTYKEY && this->vKey[slot] != _key)
+		{
+			slot = (slot + 1) & mask;
+		}
+		return slot;
+	}
+};
+
+// Per-vertex normals of an indexed triangle list in two parallel passes and no locks:
+// 1. every face normal is computed once, the faces split evenly over the worker threads;
+// 2. every vertex sums the normals of its faces, read through a vertex-to-face adjacency in CSR form (vFaceOffset
+//    into vFace), and is normalized once; the vertices split over the threads, so each normal has one writer.
+// The adjacency only depends on the indices. SetTopology builds it in parallel (degree counts, a blocked prefix
+// sum, every vertex's faces in face order so the sums do not depend on thread timing) and Compute reuses it for as
+// long as the vertex and index counts stay the same. Vertex numbers are 32 bits wide throughout.
+class NormalEngine
+{
+public:
+	std::vector<size_t> vFaceOffset;	// Faces of vertex v are vFace[vFaceOffset[v] .. vFaceOffset[v + 1])
+	std::vector<GLuint> vFace;
+	std::vector<glm::vec3> vFaceNormal;	// Unit length
+	std::vector<GLfloat> vFaceArea;
+
+	NormalEngine() : threadCount(1), topologySeconds(0.0), faceSeconds(0.0), gatherSeconds(0.0)
+	{
+	}
+
+	// _threadCount = 0 uses one worker per hardware thread
+	void SetThreadCount(const unsigned _threadCount)
+	{
+		this->threadCount = (_threadCount != 0) ? _threadCount : std::max(1u, std::thread::hardware_concurrency());
+	}
+
+	// Builds the vertex-to-face adjacency of _vIndices over _vertexCount vertices; returns false on an index out of range
+	bool SetTopology(const std::vector<GLuint>& _vIndices, const size_t _vertexCount)
+	{
+		auto start = std::chrono::steady_clock::now();
+		const size_t faceCount = _vIndices.size() / 3;
+		for (GLuint index : _vIndices)
+		{
+			if (index >= _vertexCount)
+			{
+				std::cout << "ERROR::NORMALS::INDEX_OUT_OF_RANGE" << std::endl;
+				this->vFaceOffset.clear();
+				this->vFace.clear();
+				return false;
+			}
+		}
+		this->vFaceOffset.assign(_vertexCount + 1, 0);
+		this->vFace.resize(3 * faceCount);
+
+		// One thread fills every list in face order with plain counters. Several threads count and scatter with
+		// atomic counters (uncontended, since each thread walks its own run of faces) and sort the lists after.
+		const bool serial = (this->threadCount == 1);
+		std::vector<GLuint> vDegree;
+		std::vector<std::atomic<GLuint>> vShared(serial ? 0 : _vertexCount);
+		if (serial)
+		{
+			vDegree.assign(_vertexCount, 0);
+			for (size_t k = 0; k < 3 * faceCount; k++)
+			{
+				vDegree[_vIndices[k]]++;
+			}
+		}
+		else
+		{
+			this->ParallelFor(_vertexCount, [&](size_t _begin, size_t _end)
+			{
+				for (size_t v = _begin; v < _end; v++)
+				{
+					vShared[v].store(0, std::memory_order_relaxed);
+				}
+			});
+			this->ParallelFor(faceCount, [&](size_t _begin, size_t _end)
+			{
+				for (size_t k = 3 * _begin; k < 3 * _end; k++)
+				{
+					vShared[_vIndices[k]].fetch_add(1, std::memory_order_relaxed);
+				}
+			});
+			vDegree.resize(_vertexCount);
+			this->ParallelFor(_vertexCount, [&](size_t _begin, size_t _end)
+			{
+				for (size_t v = _begin; v < _end; v++)
+				{
+					vDegree[v] = vShared[v].load(std::memory_order_relaxed);
+					vShared[v].store(0, std::memory_order_relaxed);
+				}
+			});
+		}
+
+		// Exclusive prefix sum in blocks: block totals, their running sum, then each block in parallel
+		const size_t blocks = this->threadCount;
+		const size_t blockSize = (_vertexCount + blocks - 1) / blocks;
+		std::vector<size_t> vBlockSum(blocks + 1, 0);
+		this->ParallelFor(blocks, [&](size_t _begin, size_t _end)
+		{
+			for (size_t block = _begin; block < _end; block++)
+			{
+				size_t sum = 0;
+				for (size_t v = block * blockSize; v < std::min((block + 1) * blockSize, _vertexCount); v++)
+				{
+					sum += vDegree[v];
+				}
+				vBlockSum[block + 1] = sum;
+			}
+		});
+		for (size_t block = 1; block <= blocks; block++)
+		{
+			vBlockSum[block] += vBlockSum[block - 1];
+		}
+		this->ParallelFor(blocks, [&](size_t _begin, size_t _end)
+		{
+			for (size_t block = _begin; block < _end; block++)
+			{
+				size_t offset = vBlockSum[block];
+				for (size_t v = block * blockSize; v < std::min((block + 1) * blockSize, _vertexCount); v++)
+				{
+					this->vFaceOffset[v] = offset;
+					offset += vDegree[v];
+				}
+			}
+		});
+		this->vFaceOffset[_vertexCount] = 3 * faceCount;
+
+		// Scatter the faces; the degrees count up again as fill cursors
+		if (serial)
+		{
+			std::fill(vDegree.begin(), vDegree.end(), 0);
+			for (size_t k = 0; k < 3 * faceCount; k++)
+			{
+				GLuint v = _vIndices[k];
+				this->vFace[this->vFaceOffset[v] + vDegree[v]++] = (GLuint)(k / 3);
+			}
+		}
+		else
+		{
+			this->ParallelFor(faceCount, [&](size_t _begin, size_t _end)
+			{
+				for (size_t k = 3 * _begin; k < 3 * _end; k++)
+				{
+					GLuint v = _vIndices[k];
+					this->vFace[this->vFaceOffset[v] + vShared[v].fetch_add(1, std::memory_order_relaxed)] = (GLuint)(k / 3);
+				}
+			});
+			this->ParallelFor(_vertexCount, [&](size_t _begin, size_t _end)
+			{
+				for (size_t v = _begin; v < _end; v++)
+				{
+					std::sort(this->vFace.begin() + this->vFaceOffset[v], this->vFace.begin() + this->vFaceOffset[v + 1]);
+				}
+			});
+		}
+
+		this->topologySeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		return true;
+	}
+
+	// Writes the normal of every vertex of _vVertex; rebuilds the adjacency first if the mesh size changed
+	bool Compute(std::vector<VertexAttribute>& _vVertex, const std::vector<GLuint>& _vIndices, const NormalWeight _weight = NORMAL_WEIGHT_UNIT)
+	{
+		const size_t faceCount = _vIndices.size() / 3;
+		if (this->vFaceOffset.size() != _vVertex.size() + 1 || this->vFace.size() != 3 * faceCount)
+		{
+			if (!this->SetTopology(_vIndices, _vVertex.size()))
+			{
+				return false;
+			}
+		}
+
+		// 1. Face normals, oriented like CalculateNormal: (c - b) x (a - b)
+		auto start = std::chrono::steady_clock::now();
+		this->ComputeFaceNormals(_vVertex, _vIndices);
+		auto faces = std::chrono::steady_clock::now();
+
+		// 2. Sum per vertex and normalize once
+		this->ParallelFor(_vVertex.size(), [&](size_t _begin, size_t _end)
+		{
+			for (size_t v = _begin; v < _end; v++)
+			{
+				glm::vec3 sum(0.0f);
+				for (size_t k = this->vFaceOffset[v]; k < this->vFaceOffset[v + 1]; k++)
+				{
+					const GLuint f = this->vFace[k];
+					if (_weight == NORMAL_WEIGHT_UNIT)
+					{
+						sum += this->vFaceNormal[f];
+					}
+					else
+					{
+						sum += this->CornerWeight(_vVertex, _vIndices, f, (GLuint)v, _weight) * this->vFaceNormal[f];
+					}
+				}
+				GLfloat length = glm::length(sum);
+				if (length > 0.0f)
+				{
+					_vVertex[v].normal = sum / length;
+				}
+			}
+		});
+
+		auto end = std::chrono::steady_clock::now();
+		this->faceSeconds = std::chrono::duration<double>(faces - start).count();
+		this->gatherSeconds = std::chrono::duration<double>(end - faces).count();
+		return true;
+	}
+
+	// Normals that stay sharp across creases. Where the faces on an edge turn by more than acos(_creaseCosine), or
+	// the edge is not shared by exactly two faces, the faces around each of its vertices fall into separate smooth
+	// groups (joined across the remaining edges, looked up in an EdgeMap). The first group of a vertex keeps it; every
+	// other group gets a copy appended to _vVertex with its own normal, and its face corners in _vIndices move to the
+	// copy. Vertices that are not on a crease only get their normal rewritten. _vStripIndices, if given, draws the
+	// same faces as strips joined by _restart and is re-pointed at the copies too (see RemapStripCorners), so both
+	// index buffers shade alike. Returns false on an index out of range.
+	bool SplitCreases(std::vector<VertexAttribute>& _vVertex, std::vector<GLuint>& _vIndices, const GLfloat _creaseCosine, const NormalWeight _weight, CreaseResult& _result,
+		std::vector<GLuint>* _vStripIndices = nullptr, const GLuint _restart = 0xFFFFFFFFu)
+	{
+		const size_t faceCount = _vIndices.size() / 3;
+		const size_t vertexCount = _vVertex.size();
+		if (this->vFaceOffset.size() != vertexCount + 1 || this->vFace.size() != 3 * faceCount)
+		{
+			if (!this->SetTopology(_vIndices, vertexCount))
+			{
+				return false;
+			}
+		}
+		auto start = std::chrono::steady_clock::now();
+		this->ComputeFaceNormals(_vVertex, _vIndices);
+		this->edges.Build(_vIndices, vertexCount);
+
+		_result.inputVertices = vertexCount;
+		_result.edges = this->edges.GetEdgeCount();
+		_result.creaseEdges = 0;
+		this->edges.ForEachEdge([&](GLuint _face0, GLuint _face1)
+		{
+			if (_face1 >= EdgeMap::MANYFACES || glm::dot(this->vFaceNormal[_face0], this->vFaceNormal[_face1]) < _creaseCosine)
+			{
+				_result.creaseEdges++;
+			}
+		});
+
+		// 1. Per vertex, join its faces across the smooth edges it is on (union-find over its own face list, with
+		// vCornerGroup as the parents) and number the groups; the corner slots and weights are kept for pass 3,
+		// which rewrites _vIndices while other threads would still be reading it here
+		std::vector<GLuint> vCornerGroup(this->vFace.size());
+		std::vector<unsigned char> vCornerSlot(this->vFace.size());
+		std::vector<GLfloat> vCornerWeight(this->vFace.size());
+		std::vector<GLuint> vGroupCount(vertexCount);
+		this->ParallelFor(vertexCount, [&](size_t _begin, size_t _end)
+		{
+			for (size_t v = _begin; v < _end; v++)
+			{
+				const size_t first = this->vFaceOffset[v], degree = this->vFaceOffset[v + 1] - first;
+				GLuint* parent = vCornerGroup.data() + first;
+				auto root = [&](GLuint _i)
+				{
+					while (parent[_i] != _i)
+					{
+						_i = parent[_i] = parent[parent[_i]];
+					}
+					return _i;
+				};
+				for (size_t i = 0; i < degree; i++)
+				{
+					parent[i] = (GLuint)i;
+				}
+				for (size_t i = 0; i < degree; i++)
+				{
+					const GLuint f = this->vFace[first + i];
+					size_t slot = 0;
+					while (slot < 2 && _vIndices[3 * f + slot] != v)
+					{
+						slot++;
+					}
+					vCornerSlot[first + i] = (unsigned char)slot;
+					vCornerWeight[first + i] = this->CornerWeight(_vVertex, _vIndices, f, (GLuint)v, _weight);
+					// The two edges of f at v: the one leaving its corner and the one arriving at it
+					for (size_t edge : { slot, (slot + 2) % 3 })
+					{
+						const GLuint g = this->edges.Across(f, edge);
+						if (g >= EdgeMap::MANYFACES || glm::dot(this->vFaceNormal[f], this->vFaceNormal[g]) < _creaseCosine)
+						{
+							continue;
+						}
+						for (size_t j = 0; j < degree; j++)
+						{
+							if (this->vFace[first + j] == g)
+							{
+								// The smaller root wins, so every group's root is its first face
+								GLuint a = root((GLuint)i), b = root((GLuint)j);
+								parent[std::max(a, b)] = std::min(a, b);
+								break;
+							}
+						}
+					}
+				}
+				// Number the groups in the order of their first face. Roots come before their members, so a member
+				// finds its root already numbered (offset by degree to tell numbers from parents) when it is reached.
+				GLuint groups = 0;
+				for (size_t i = 0; i < degree; i++)
+				{
+					parent[i] = root((GLuint)i);
+				}
+				for (size_t i = 0; i < degree; i++)
+				{
+					parent[i] = (parent[i] == i) ? (GLuint)(degree + groups++) : parent[parent[i]];
+				}
+				for (size_t i = 0; i < degree; i++)
+				{
+					parent[i] -= (GLuint)degree;
+				}
+				vGroupCount[v] = groups;
+			}
+		});
+
+		// 2. Number the copies: those of vertex v follow the copies of all vertices before it
+		std::vector<size_t> vFirstCopy(vertexCount);
+		std::vector<GLuint> vOriginal(vertexCount);
+		size_t copies = 0;
+		for (size_t v = 0; v < vertexCount; v++)
+		{
+			vFirstCopy[v] = vertexCount + copies;
+			vOriginal[v] = (GLuint)v;
+			copies += (vGroupCount[v] > 1) ? vGroupCount[v] - 1 : 0;
+			vOriginal.resize(vertexCount + copies, (GLuint)v);
+		}
+		_vVertex.resize(vertexCount + copies);
+
+		// 3. Sum every group, normalize once, write the vertex or its copy and move the corners of the copies
+		this->ParallelFor(vertexCount, [&](size_t _begin, size_t _end)
+		{
+			std::vector<glm::vec3> vSum;
+			for (size_t v = _begin; v < _end; v++)
+			{
+				const size_t first = this->vFaceOffset[v], degree = this->vFaceOffset[v + 1] - first;
+				vSum.assign(vGroupCount[v], glm::vec3(0.0f));
+				for (size_t i = 0; i < degree; i++)
+				{
+					vSum[vCornerGroup[first + i]] += vCornerWeight[first + i] * this->vFaceNormal[this->vFace[first + i]];
+				}
+				for (GLuint group = 0; group < vGroupCount[v]; group++)
+				{
+					const size_t target = (group == 0) ? v : vFirstCopy[v] + group - 1;
+					if (group != 0)
+					{
+						_vVertex[target] = _vVertex[v];
+					}
+					GLfloat length = glm::length(vSum[group]);
+					if (length > 0.0f)
+					{
+						_vVertex[target].normal = vSum[group] / length;
+					}
+				}
+				for (size_t i = 0; i < degree; i++)
+				{
+					if (vCornerGroup[first + i] != 0)
+					{
+						_vIndices[3 * this->vFace[first + i] + vCornerSlot[first + i]] = (GLuint)(vFirstCopy[v] + vCornerGroup[first + i] - 1);
+					}
+				}
+			}
+		});
+
+		if (_vStripIndices != nullptr)
+		{
+			this->RemapStripCorners(_vIndices, vOriginal, *_vStripIndices, _restart);
+		}
+
+		_result.outputVertices = _vVertex.size();
+		this->faceSeconds = 0.0;
+		this->gatherSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		return true;
+	}
+
+	void Report(std::ostream& _out) const
+	{
+		_out << "normals on " << this->threadCount << " threads: adjacency " << this->topologySeconds * 1000.0 << " ms, faces "
+			<< this->faceSeconds * 1000.0 << " ms, gather " << this->gatherSeconds * 1000.0 << " ms" << std::endl;
+	}
+
+	double GetComputeSeconds() const
+	{
+		return this->faceSeconds + this->gatherSeconds;
+	}
+
+	double GetTopologySeconds() const
+	{
+		return this->topologySeconds;
+	}
+
+private:
+	unsigned threadCount;
+	double topologySeconds;
+	double faceSeconds;
+	double gatherSeconds;
+	EdgeMap edges;
+
+	// Rewrites strips still numbered as before SplitCreases with the corners the split gave their faces in _vIndices.
+	// Each strip triangle is found among the faces of its first vertex (the adjacency is still the one before the
+	// split, _vOriginal maps copies back). Where the next triangle's first two corners are not the last two indices
+	// written, the strip crosses a crease: a new strip starts there, with its first index doubled when the triangle
+	// was an odd one so the winding stays the same. Degenerate triangles draw nothing and are dropped.
+	void RemapStripCorners(const std::vector<GLuint>& _vIndices, const std::vector<GLuint>& _vOriginal, std::vector<GLuint>& _vStrip, const GLuint _restart) const
+	{
+		const size_t vertexCount = this->vFaceOffset.size() - 1;
+		std::vector<GLuint> vOut;
+		vOut.reserve(_vStrip.size() + _vStrip.size() / 8);
+		size_t stripBegin = 0, outBegin = 0;
+		for (size_t k = 0; k + 2 < _vStrip.size(); k++)
+		{
+			const GLuint corner[3] = { _vStrip[k], _vStrip[k + 1], _vStrip[k + 2] };
+			if (corner[0] == _restart)
+			{
+				stripBegin = k + 1;
+				continue;
+			}
+			if (corner[1] == _restart || corner[2] == _restart || corner[0] == corner[1] || corner[1] == corner[2] || corner[0] == corner[2]
+				|| corner[0] >= vertexCount || corner[1] >= vertexCount || corner[2] >= vertexCount)
+			{
+				continue;
+			}
+
+			GLuint mapped[3] = { corner[0], corner[1], corner[2] };
+			for (size_t i = this->vFaceOffset[corner[0]]; i < this->vFaceOffset[corner[0] + 1]; i++)
+			{
+				const GLuint* face = _vIndices.data() + 3 * this->vFace[i];
+				int found = 0;
+				for (int j = 0; j < 3; j++)
+				{
+					for (int m = 0; m < 3; m++)
+					{
+						if (_vOriginal[face[m]] == corner[j])
+						{
+							mapped[j] = face[m];
+							found++;
+							break;
+						}
+					}
+				}
+				if (found == 3)
+				{
+					break;
+				}
+			}
+
+			const bool odd = ((k - stripBegin) & 1) != 0;
+			const size_t written = vOut.size() - outBegin;
+			if (written >= 2 && vOut[vOut.size() - 2] == mapped[0] && vOut.back() == mapped[1] && (((written - 2) & 1) != 0) == odd)
+			{
+				vOut.push_back(mapped[2]);
+				continue;
+			}
+			if (!vOut.empty())
+			{
+				vOut.push_back(_restart);
+			}
+			outBegin = vOut.size();
+			if (odd)
+			{
+				vOut.push_back(mapped[0]);
+			}
+			vOut.insert(vOut.end(), mapped, mapped + 3);
+		}
+		_vStrip.swap(vOut);
+	}
+
+	// Unit normal and area of every face, the faces split over the threads
+	void ComputeFaceNormals(const std::vector<VertexAttribute>& _vVertex, const std::vector<GLuint>& _vIndices)
+	{
+		const size_t faceCount = _vIndices.size() / 3;
+		this->vFaceNormal.resize(faceCount);
+		this->vFaceArea.resize(faceCount);
+		this->ParallelFor(faceCount, [&](size_t _begin, size_t _end)
+		{
+			for (size_t f = _begin; f < _end; f++)
+			{
+				const VertexAttribute& a = _vVertex[_vIndices[3 * f]];
+				const VertexAttribute& b = _vVertex[_vIndices[3 * f + 1]];
+				const VertexAttribute& c = _vVertex[_vIndices[3 * f + 2]];
+				glm::vec3 normal = glm::cross(glm::vec3(c.x - b.x, c.y - b.y, c.z - b.z), glm::vec3(a.x - b.x, a.y - b.y, a.z - b.z));
+				GLfloat length = glm::length(normal);
+				this->vFaceNormal[f] = (length > 0.0f) ? normal / length : glm::vec3(0.0f);
+				this->vFaceArea[f] = 0.5f * length;
+			}
+		});
+	}
+
+	// What face _face contributes to the normal of its corner at vertex _v
+	GLfloat CornerWeight(const std::vector<VertexAttribute>& _vVertex, const std::vector<GLuint>& _vIndices, const GLuint _face, const GLuint _v, const NormalWeight _weight) const
+	{
+		if (_weight == NORMAL_WEIGHT_UNIT)
+		{
+			return 1.0f;
+		}
+		if (_weight == NORMAL_WEIGHT_AREA)
+		{
+			return this->vFaceArea[_face];
+		}
+		size_t slot = 0;
+		while (slot < 2 && _vIndices[3 * _face + slot] != _v)
+		{
+			slot++;
+		}
+		const VertexAttribute& p = _vVertex[_v];
+		const VertexAttribute& q = _vVertex[_vIndices[3 * _face + (slot + 1) % 3]];
+		const VertexAttribute& r = _vVertex[_vIndices[3 * _face + (slot + 2) % 3]];
+		glm::vec3 e1(q.x - p.x, q.y - p.y, q.z - p.z), e2(r.x - p.x, r.y - p.y, r.z - p.z);
+		return std::atan2(glm::length(glm::cross(e1, e2)), glm::dot(e1, e2));
+	}
+
+	// Splits [0, _count) into one contiguous range per thread and runs _work(begin, end) on each
+	template <class Work>
+	void ParallelFor(const size_t _count, Work _work)
+	{
+		const size_t threads = std::min<size_t>(this->threadCount, std::max<size_t>(_count, 1));
+		if (threads <= 1)
+		{
+			_work(0, _count);
+			return;
+		}
+		std::vector<std::thread> vThread;
+		for (size_t t = 1; t < threads; t++)
+		{
+			vThread.emplace_back(_work, _count * t / threads, _count * (t + 1) / threads);
+		}
+		_work(0, _count / threads);
+		for (std::thread& thread : vThread)
+		{
+			thread.join();
+		}
+	}
+};
+
+// Splits a mesh's normals at edges sharper than _creaseDegrees (see NormalEngine::SplitCreases) and prints the result.
+// _vStripIndices, strips of the same faces joined by _restart, are re-pointed at the split vertices as well.
+inline bool CreaseMesh(const char* _name, std::vector<VertexAttribute>& _vVertex, std::vector<GLuint>& _vIndices, const GLfloat _creaseDegrees, const NormalWeight _weight = NORMAL_WEIGHT_ANGLE,
+	std::vector<GLuint>* _vStripIndices = nullptr, const GLuint _restart = 0xFFFFFFFFu)
+{
+	NormalEngine normals;
+	normals.SetThreadCount(0);
+	CreaseResult result;
+	if (!normals.SplitCreases(_vVertex, _vIndices, std::cos(glm::radians(_creaseDegrees)), _weight, result, _vStripIndices, _restart))
+	{
+		return false;
+	}
+	std::cout << _name << " creases (" << _creaseDegrees << " degrees): " << result.creaseEdges << " of " << result.edges << " edges, "
+		<< result.outputVertices - result.inputVertices << " vertices split off" << std::endl;
+	return true;
+}
@@ -0,0 +1,234 @@
+#pragma once
+
+// Std. Includes
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+// GL Includes
+#include <GL/glew.h>
+
+#include <glm/glm.hpp>
+
+// Other includes
+#include "VertexAttribute.h"
+
+// Bits per component of the octahedral normal in a PackedMesh
+enum PackedNormalBits
+{
+	PACKED_NORMAL_8 = 8,	// 8 bytes per vertex
+	PACKED_NORMAL_16 = 16	// 12 bytes per vertex
+};
+
+// Largest and mean difference between a mesh and its packed copy
+struct PackedVertexError
+{
+	GLfloat maxPosition;	// Model units
+	GLfloat meanPosition;
+	GLfloat maxNormalDegrees;
+	GLfloat meanNormalDegrees;
+};
+
+// Compact copy of a VertexAttribute mesh, decoded in core.vertexshader when vertexFormat is 1.
+// Positions are 3 x 16-bit unorm relative to the mesh bounding box (boxMin + value * boxExtent); normals are
+// folded onto an octahedron and stored as 2 snorm components of 8 or 16 bits. With 8-bit normals they follow
+// the position directly, with 16-bit normals the short before them (which keeps them 4-byte aligned) holds the
+// span as an integer; 8-bit meshes have no room for it and read span 0, so they are not deflected.
+class PackedMesh
+{
+public:
+	std::vector<GLubyte> vData;
+	glm::vec3 boxMin;
+	glm::vec3 boxExtent;
+
+	PackedMesh() : boxMin(0.0f), boxExtent(0.0f), normalBits(PACKED_NORMAL_16), stride(12)
+	{
+	}
+
+	void Pack(const std::vector<VertexAttribute>& _vVertex, const PackedNormalBits _normalBits)
+	{
+		this->normalBits = _normalBits;
+		this->stride = (_normalBits == PACKED_NORMAL_8) ? 8 : 12;
+		this->vData.assign(_vVertex.size() * this->stride, 0);
+
+		glm::vec3 boxMax(0.0f);
+		this->boxMin = glm::vec3(0.0f);
+		if (!_vVertex.empty())
+		{
+			this->boxMin = boxMax = glm::vec3(_vVertex[0].x, _vVertex[0].y, _vVertex[0].z);
+		}
+		for (const VertexAttribute& vertex : _vVertex)
+		{
+			glm::vec3 p(vertex.x, vertex.y, vertex.z);
+			this->boxMin = glm::min(this->boxMin, p);
+			boxMax = glm::max(boxMax, p);
+		}
+		this->boxExtent = boxMax - this->boxMin;
+
+		for (size_t i = 0; i < _vVertex.size(); i++)
+		{
+			GLubyte* vertex = &this->vData[i * this->stride];
+			const GLfloat p[3] = { _vVertex[i].x, _vVertex[i].y, _vVertex[i].z };
+			for (int c = 0; c < 3; c++)
+			{
+				GLfloat t = (this->boxExtent[c] > 0.0f) ? (p[c] - this->boxMin[c]) / this->boxExtent[c] : 0.0f;
+				GLushort q = (GLushort)std::lround(std::min(std::max(t, 0.0f), 1.0f) * 65535.0f);
+				std::memcpy(vertex + 2 * c, &q, sizeof(q));
+			}
+
+			glm::vec2 oct = OctEncode(_vVertex[i].normal);
+			if (_normalBits == PACKED_NORMAL_8)
+			{
+				GLbyte n[2] = { (GLbyte)std::lround(oct.x * 127.0f), (GLbyte)std::lround(oct.y * 127.0f) };
+				std::memcpy(vertex + 6, n, sizeof(n));
+			}
+			else
+			{
+				GLushort span = (GLushort)std::lround(std::min(std::max(_vVertex[i].span, 0.0f), 65535.0f));
+				std::memcpy(vertex + 6, &span, sizeof(span));
+				GLshort n[2] = { (GLshort)std::lround(oct.x * 32767.0f), (GLshort)std::lround(oct.y * 32767.0f) };
+				std::memcpy(vertex + 8, n, sizeof(n));
+			}
+		}
+	}
+
+	// Decodes vertex _index the way the vertex shader does
+	VertexAttribute Unpack(const size_t _index) const
+	{
+		const GLubyte* vertex = &this->vData[_index * this->stride];
+		VertexAttribute result;
+		GLushort q[3];
+		std::memcpy(q, vertex, sizeof(q));
+		result.x = this->boxMin.x + q[0] / 65535.0f * this->boxExtent.x;
+		result.y = this->boxMin.y + q[1] / 65535.0f * this->boxExtent.y;
+		result.z = this->boxMin.z + q[2] / 65535.0f * this->boxExtent.z;
+
+		glm::vec2 oct;
+		result.span = 0.0f;
+		if (this->normalBits == PACKED_NORMAL_8)
+		{
+			GLbyte n[2];
+			std::memcpy(n, vertex + 6, sizeof(n));
+			oct = glm::max(glm::vec2(n[0], n[1]) / 127.0f, glm::vec2(-1.0f));
+		}
+		else
+		{
+			GLushort span;
+			std::memcpy(&span, vertex + 6, sizeof(span));
+			result.span = (GLfloat)span;
+			GLshort n[2];
+			std::memcpy(n, vertex + 8, sizeof(n));
+			oct = glm::max(glm::vec2(n[0], n[1]) / 32767.0f, glm::vec2(-1.0f));
+		}
+		result.normal = OctDecode(oct);
+		return result;
+	}
+
+	PackedVertexError Measure(const std::vector<VertexAttribute>& _vVertex) const
+	{
+		PackedVertexError error = { 0.0f, 0.0f, 0.0f, 0.0f };
+		size_t normalCount = 0;
+		for (size_t i = 0; i < _vVertex.size(); i++)
+		{
+			VertexAttribute decoded = this->Unpack(i);
+			GLfloat positionError = glm::length(glm::vec3(decoded.x - _vVertex[i].x, decoded.y - _vVertex[i].y, decoded.z - _vVertex[i].z));
+			error.maxPosition = std::max(error.maxPosition, positionError);
+			error.meanPosition += positionError;
+
+			GLfloat length = glm::length(_vVertex[i].normal);
+			if (length > 0.0f)
+			{
+				GLfloat cosine = glm::dot(_vVertex[i].normal / length, glm::normalize(decoded.normal));
+				GLfloat degrees = glm::degrees(std::acos(std::min(std::max(cosine, -1.0f), 1.0f)));
+				error.maxNormalDegrees = std::max(error.maxNormalDegrees, degrees);
+				error.meanNormalDegrees += degrees;
+				normalCount++;
+			}
+		}
+		if (!_vVertex.empty())
+		{
+			error.meanPosition /= (GLfloat)_vVertex.size();
+		}
+		if (normalCount > 0)
+		{
+			error.meanNormalDegrees /= (GLfloat)normalCount;
+		}
+		return error;
+	}
+
+	// Points the position, normal and span attributes of the bound VAO at the bound array buffer
+	void SetupAttributes(GLuint _vp, GLuint _vn, GLuint _vs) const
+	{
+		glEnableVertexAttribArray(_vp);
+		glVertexAttribPointer(_vp, 3, GL_UNSIGNED_SHORT, GL_TRUE, this->stride, (GLvoid*)0);
+		glEnableVertexAttribArray(_vn);
+		if (this->normalBits == PACKED_NORMAL_8)
+		{
+			glVertexAttribPointer(_vn, 2, GL_BYTE, GL_TRUE, this->stride, (GLvoid*)6);
+			glDisableVertexAttribArray(_vs);
+		}
+		else
+		{
+			glVertexAttribPointer(_vn, 2, GL_SHORT, GL_TRUE, this->stride, (GLvoid*)8);
+			glEnableVertexAttribArray(_vs);
+			glVertexAttribPointer(_vs, 1, GL_UNSIGNED_SHORT, GL_FALSE, this->stride, (GLvoid*)6);
+		}
+	}
+
+	// Switches the program to the packed decode for this mesh; set vertexFormat back to 0 for float meshes
+	void SetUniforms(GLuint _program) const
+	{
+		glUniform1i(glGetUniformLocation(_program, "vertexFormat"), 1);
+		glUniform3fv(glGetUniformLocation(_program, "boxMin"), 1, &this->boxMin[0]);
+		glUniform3fv(glGetUniformLocation(_program, "boxExtent"), 1, &this->boxExtent[0]);
+	}
+
+	void Report(const char* _name, const std::vector<VertexAttribute>& _vVertex) const
+	{
+		PackedVertexError error = this->Measure(_vVertex);
+		GLfloat diagonal = glm::length(this->boxExtent);
+		std::cout << _name << " packed to " << this->stride << " bytes/vertex (" << this->vData.size() << " bytes, float layout "
+			<< sizeof(VertexAttribute) * _vVertex.size() << "): position error max " << error.maxPosition
+			<< " (" << ((diagonal > 0.0f) ? error.maxPosition / diagonal : 0.0f) << " of the box diagonal), mean " << error.meanPosition
+			<< "; normal error max " << error.maxNormalDegrees << " deg, mean " << error.meanNormalDegrees << " deg" << std::endl;
+	}
+
+	GLsizei GetStride() const
+	{
+		return this->stride;
+	}
+
+	// Octahedral mapping of a direction to [-1, 1]^2 (Meyer et al. 2010); the lower half is folded over the diagonals
+	static glm::vec2 OctEncode(const glm::vec3& _normal)
+	{
+		GLfloat sum = std::fabs(_normal.x) + std::fabs(_normal.y) + std::fabs(_normal.z);
+		if (sum == 0.0f)
+		{
+			return glm::vec2(0.0f);
+		}
+		glm::vec2 oct = glm::vec2(_normal.x, _normal.y) / sum;
+		if (_normal.z < 0.0f)
+		{
+			oct = (1.0f - glm::abs(glm::vec2(oct.y, oct.x))) * glm::vec2(oct.x >= 0.0f ? 1.0f : -1.0f, oct.y >= 0.0f ? 1.0f : -1.0f);
+		}
+		return oct;
+	}
+
+	static glm::vec3 OctDecode(const glm::vec2& _oct)
+	{
+		glm::vec3 normal(_oct.x, _oct.y, 1.0f - std::fabs(_oct.x) - std::fabs(_oct.y));
+		if (normal.z < 0.0f)
+		{
+			glm::vec2 folded = (1.0f - glm::abs(glm::vec2(normal.y, normal.x))) * glm::vec2(normal.x >= 0.0f ? 1.0f : -1.0f, normal.y >= 0.0f ? 1.0f : -1.0f);
+			normal.x = folded.x;
+			normal.y = folded.y;
+		}
+		return glm::normalize(normal);
+	}
+
+private:
+	PackedNormalBits normalBits;
+	GLsizei stride;
+};
@@ -0,0 +1,110 @@
+#pragma once
+
+// Std. Includes
+#include <vector>
+
+// GL Includes
+#include <GL/glew.h>
+
+// Other includes
+#include "VertexAttribute.h"
+
+// Draws the blade loft straight from the base profile. The profile is uploaded once into a texture buffer
+// and core.vertexshader rebuilds every section from gl_InstanceID (section pair) and gl_VertexID (corner of
+// a profile segment quad), so neither the FOILMAX copies of the profile nor an index buffer are uploaded.
+// The corners are emitted in the order of MakeFoil's index pattern, so the triangles are the same.
+// Only MakeFoil's loft is reproduced: blade stations are not blended in and the normals come from the smooth
+// loft surface, without crease splits, so the blade is shaded differently when those are in use.
+class ProceduralLoft
+{
+public:
+	ProceduralLoft() : VAO(0), TBO(0), texture(0), pointCount(0)
+	{
+	}
+
+	~ProceduralLoft()
+	{
+		this->Release();
+	}
+
+	ProceduralLoft(const ProceduralLoft&) = delete;
+	ProceduralLoft& operator=(const ProceduralLoft&) = delete;
+
+	// (Re)uploads the base profile; one RGBA32F texel per point since RGB32F buffer textures need GL 4.0
+	void Upload(const std::vector<VertexAttribute>& _vProfile)
+	{
+		if (0 == this->VAO)
+		{
+			// The vertex shader fetches everything itself, but core profile draws still need a bound VAO
+			glGenVertexArrays(1, &this->VAO);
+			glGenBuffers(1, &this->TBO);
+			glGenTextures(1, &this->texture);
+		}
+		std::vector<GLfloat> texels;
+		texels.reserve(4 * _vProfile.size());
+		for (const VertexAttribute& var : _vProfile)
+		{
+			texels.push_back(var.x);
+			texels.push_back(var.y);
+			texels.push_back(var.z);
+			texels.push_back(1.0f);
+		}
+		this->pointCount = (GLint)_vProfile.size();
+		glBindBuffer(GL_TEXTURE_BUFFER, this->TBO);
+		glBufferData(GL_TEXTURE_BUFFER, sizeof(GLfloat) * texels.size(), texels.data(), GL_STATIC_DRAW);
+		glBindTexture(GL_TEXTURE_BUFFER, this->texture);
+		glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA32F, this->TBO);
+		glBindTexture(GL_TEXTURE_BUFFER, 0);
+		glBindBuffer(GL_TEXTURE_BUFFER, 0);
+	}
+
+	// Draws the _FOILMAX section pairs as triangles, or every section's points when _points is set.
+	// The program must be in use; the model/view/projection uniforms are left to the caller.
+	void Draw(GLuint _program, const GLuint _FOILMAX, bool _points = false) const
+	{
+		if (this->pointCount < 2)
+		{
+			return;
+		}
+		glActiveTexture(GL_TEXTURE0);
+		glBindTexture(GL_TEXTURE_BUFFER, this->texture);
+		glUniform1i(glGetUniformLocation(_program, "profile"), 0);
+		glUniform1i(glGetUniformLocation(_program, "profilePoints"), this->pointCount);
+		glUniform1i(glGetUniformLocation(_program, "foilMax"), (GLint)_FOILMAX);
+		glUniform1i(glGetUniformLocation(_program, "loftMode"), _points ? 2 : 1);
+		glBindVertexArray(this->VAO);
+		if (_points)
+		{
+			glDrawArraysInstanced(GL_POINTS, 0, this->pointCount, _FOILMAX + 1);
+		}
+		else
+		{
+			glDrawArraysInstanced(GL_TRIANGLES, 0, (this->pointCount - 1) * 6, _FOILMAX);
+		}
+		glBindVertexArray(0);
+		glUniform1i(glGetUniformLocation(_program, "loftMode"), 0);
+		glBindTexture(GL_TEXTURE_BUFFER, 0);
+	}
+
+	// Bytes resident on the GPU for the procedural blade
+	size_t GetUploadedBytes() const
+	{
+		return 4 * sizeof(GLfloat) * this->pointCount;
+	}
+
+	void Release()
+	{
+		if (0 != this->VAO)
+		{
+			glDeleteTextures(1, &this->texture);
+			glDeleteBuffers(1, &this->TBO);
+			glDeleteVertexArrays(1, &this->VAO);
+		}
+		this->VAO = this->TBO = this->texture = 0;
+		this->pointCount = 0;
+	}
+
+private:
+	GLuint VAO, TBO, texture;
+	GLint pointCount;
+};
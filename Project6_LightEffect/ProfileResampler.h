@@ -0,0 +1,276 @@
+#pragma once
+
+// Std. Includes
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+// GL Includes
+#include <GL/glew.h>
+
+// Eigen (OpenGL_Dependency/ext/eigen)
+#include <Eigen/Core>
+#include <unsupported/Eigen/Splines>
+
+// Other includes
+#include "VertexAttribute.h"
+
+// Outcome of a resampling: point counts, the largest distance of an original point to the new polyline, and
+// for comparison how far the original polyline itself strays from the fitted spline between its points
+struct ResampleResult
+{
+	size_t inputPoints;
+	size_t outputPoints;
+	GLfloat maxError;
+	GLfloat inputError;
+};
+
+// Largest distance from the original points to the polyline through _vResampled. _inputParam and _outputParam are
+// the chord-length parameters of both point sets, which lets one merge walk find the segment of each original point.
+inline GLfloat MeasureProfileError(const std::vector<VertexAttribute>& _vProfile, const std::vector<float>& _inputParam,
+	const std::vector<VertexAttribute>& _vResampled, const std::vector<float>& _outputParam)
+{
+	GLfloat maxError = 0.0f;
+	size_t segment = 0;
+	for (size_t i = 0; i < _vProfile.size(); i++)
+	{
+		while (segment + 2 < _outputParam.size() && _outputParam[segment + 1] < _inputParam[i])
+		{
+			segment++;
+		}
+		glm::vec2 a(_vResampled[segment].x, _vResampled[segment].y);
+		glm::vec2 b(_vResampled[segment + 1].x, _vResampled[segment + 1].y);
+		glm::vec2 p(_vProfile[i].x, _vProfile[i].y);
+		glm::vec2 ab = b - a;
+		GLfloat t = glm::dot(ab, ab) > 0.0f ? glm::clamp(glm::dot(p - a, ab) / glm::dot(ab, ab), 0.0f, 1.0f) : 0.0f;
+		maxError = std::max(maxError, glm::length(p - (a + t * ab)));
+	}
+	return maxError;
+}
+
+// Re-emits a profile with points placed by curvature. A cubic B-spline is fitted through the profile with Eigen's
+// SplineFitting (through an evenly strided subset of at most _maxFitPoints points, since the fit is a dense solve),
+// then every parameter interval is bisected until the spline deviates from the chord by less than _tolerance.
+// Flat stretches end up with few points and the leading edge with many. The first and last points are kept exactly.
+inline ResampleResult ResampleProfile(const std::vector<VertexAttribute>& _vProfile, GLfloat _tolerance, std::vector<VertexAttribute>& _vResampled, size_t _maxFitPoints = 1024)
+{
+	typedef Eigen::Spline<float, 2> ProfileSpline;
+	ResampleResult result = { _vProfile.size(), _vProfile.size(), 0.0f, 0.0f };
+	_vResampled = _vProfile;
+	if (_vProfile.size() < 4 || _tolerance <= 0.0f)
+	{
+		return result;
+	}
+
+	// 1. Chord-length parameter of every original point
+	const size_t count = _vProfile.size();
+	std::vector<float> inputParam(count, 0.0f);
+	for (size_t i = 1; i < count; i++)
+	{
+		inputParam[i] = inputParam[i - 1] + std::hypot(_vProfile[i].x - _vProfile[i - 1].x, _vProfile[i].y - _vProfile[i - 1].y);
+	}
+	const float length = inputParam.back();
+	if (length <= 0.0f)
+	{
+		return result;
+	}
+	for (float& u : inputParam)
+	{
+		u /= length;
+	}
+	inputParam.back() = 1.0f;
+
+	// 2. Fit the spline, at least through both ends; a subset of fewer than 4 points lowers the degree to fit it
+	const size_t maxFitPoints = std::max<size_t>(_maxFitPoints, 2);
+	const size_t stride = (count + maxFitPoints - 2) / (maxFitPoints - 1);
+	const size_t fitCount = (count - 1 + stride - 1) / stride + 1;
+	Eigen::MatrixXf fitPoints(2, fitCount);
+	Eigen::RowVectorXf fitParam(fitCount);
+	for (size_t i = 0; i < fitCount; i++)
+	{
+		size_t source = std::min(i * stride, count - 1);
+		fitPoints(0, i) = _vProfile[source].x;
+		fitPoints(1, i) = _vProfile[source].y;
+		fitParam(i) = inputParam[source];
+	}
+	const ProfileSpline spline = Eigen::SplineFitting<ProfileSpline>::Interpolate(fitPoints, (int)std::min<size_t>(3, fitCount - 1), fitParam);
+
+	// 3. Bisect each interval until its chord is within the tolerance, probing the quarter points too
+	std::vector<float> outputParam;
+	const int startIntervals = 16, maxDepth = 24;
+	struct Interval { float u0, u1; int depth; };
+	std::vector<Interval> stack;
+	outputParam.push_back(0.0f);
+	for (int i = startIntervals - 1; i >= 0; i--)
+	{
+		stack.push_back({ (float)i / startIntervals, (float)(i + 1) / startIntervals, 0 });
+	}
+	while (!stack.empty())
+	{
+		Interval interval = stack.back();
+		stack.pop_back();
+		ProfileSpline::PointType a = spline(interval.u0), b = spline(interval.u1);
+		Eigen::Vector2f ab = (b - a).matrix();
+		float deviation = 0.0f;
+		for (int q = 1; q <= 3; q++)
+		{
+			Eigen::Vector2f p = spline(interval.u0 + (interval.u1 - interval.u0) * q / 4.0f).matrix();
+			Eigen::Vector2f ap = p - a.matrix();
+			float t = ab.squaredNorm() > 0.0f ? std::min(std::max(ap.dot(ab) / ab.squaredNorm(), 0.0f), 1.0f) : 0.0f;
+			deviation = std::max(deviation, (ap - t * ab).norm());
+		}
+		if (deviation > _tolerance && interval.depth < maxDepth)
+		{
+			float mid = 0.5f * (interval.u0 + interval.u1);
+			stack.push_back({ mid, interval.u1, interval.depth + 1 });
+			stack.push_back({ interval.u0, mid, interval.depth + 1 });
+		}
+		else
+		{
+			outputParam.push_back(interval.u1);
+		}
+	}
+
+	// 4. Emit the points on the spline, keeping the exact end points of the (closed) profile
+	_vResampled.resize(outputParam.size());
+	for (size_t i = 0; i < outputParam.size(); i++)
+	{
+		ProfileSpline::PointType p = spline(outputParam[i]);
+		_vResampled[i] = { p(0), p(1), _vProfile.front().z, glm::vec3(0.0f, 0.0f, 0.0f) };
+	}
+	_vResampled.front() = _vProfile.front();
+	_vResampled.back() = _vProfile.back();
+
+	for (size_t i = 0; i + 1 < count; i++)
+	{
+		Eigen::Vector2f a(_vProfile[i].x, _vProfile[i].y), b(_vProfile[i + 1].x, _vProfile[i + 1].y);
+		Eigen::Vector2f mid = spline(0.5f * (inputParam[i] + inputParam[i + 1])).matrix();
+		result.inputError = std::max(result.inputError, (mid - 0.5f * (a + b)).norm());
+	}
+	result.outputPoints = _vResampled.size();
+	result.maxError = MeasureProfileError(_vProfile, inputParam, _vResampled, outputParam);
+	return result;
+}
+
+// Leading edge of a closed profile: the point farthest from its trailing edge, the first point
+inline size_t FindLeadingEdge(const std::vector<VertexAttribute>& _vProfile)
+{
+	const glm::vec2 trailing = _vProfile.empty() ? glm::vec2(0.0f) : glm::vec2(_vProfile.front().x, _vProfile.front().y);
+	size_t leading = 0;
+	GLfloat farthest = -1.0f;
+	for (size_t i = 0; i < _vProfile.size(); i++)
+	{
+		GLfloat distance = glm::length(glm::vec2(_vProfile[i].x, _vProfile[i].y) - trailing);
+		if (distance > farthest)
+		{
+			farthest = distance;
+			leading = i;
+		}
+	}
+	return leading;
+}
+
+// Moves and turns _vProfile so its trailing edge lands on _trailingEdge and its chord points along _chordDirection,
+// keeping its own chord length
+inline void RegisterProfile(std::vector<VertexAttribute>& _vProfile, const glm::vec2 _trailingEdge, const glm::vec2 _chordDirection)
+{
+	if (_vProfile.empty())
+	{
+		return;
+	}
+	const glm::vec2 trailing(_vProfile.front().x, _vProfile.front().y);
+	const VertexAttribute& leading = _vProfile[FindLeadingEdge(_vProfile)];
+	const glm::vec2 chord = glm::vec2(leading.x, leading.y) - trailing;
+	if (glm::length(chord) <= 0.0f || glm::length(_chordDirection) <= 0.0f)
+	{
+		return;
+	}
+	const glm::vec2 from = glm::normalize(chord), to = glm::normalize(_chordDirection);
+	const GLfloat cosine = glm::dot(from, to), sine = from.x * to.y - from.y * to.x;
+	for (VertexAttribute& var : _vProfile)
+	{
+		const glm::vec2 p = glm::vec2(var.x, var.y) - trailing;
+		var.x = _trailingEdge.x + cosine * p.x - sine * p.y;
+		var.y = _trailingEdge.y + sine * p.x + cosine * p.y;
+	}
+}
+
+// Resamples a closed profile onto a parameterization shared by every profile, so profiles resampled with the
+// same _points correspond point by point and can be blended linearly (LoftEngine::SetStations). The profile is
+// split at its leading edge (FindLeadingEdge) and both surfaces are sampled at the same cosine-spaced fractions
+// of their arc length, which clusters points at both edges.
+// An even _points is rounded up to the next odd count so the leading edge is a point of its own.
+inline void ResampleCorresponding(const std::vector<VertexAttribute>& _vProfile, size_t _points, std::vector<VertexAttribute>& _vResampled)
+{
+	_vResampled.clear();
+	const size_t count = _vProfile.size();
+	if (count < 3)
+	{
+		_vResampled = _vProfile;
+		return;
+	}
+	const size_t perSurface = std::max<size_t>(_points / 2 + 1, 2);
+	const size_t leading = FindLeadingEdge(_vProfile);
+
+	// Both surfaces, each walked from its first point with a running arc length
+	const GLfloat PI = 3.14159265358979f;
+	const size_t surfaceBegin[2] = { 0, leading };
+	const size_t surfaceEnd[2] = { leading, count - 1 };
+	std::vector<GLfloat> arc;
+	_vResampled.reserve(2 * perSurface - 1);
+	for (int surface = 0; surface < 2; surface++)
+	{
+		const size_t first = surfaceBegin[surface], last = surfaceEnd[surface];
+		arc.assign(1, 0.0f);
+		for (size_t i = first + 1; i <= last; i++)
+		{
+			arc.push_back(arc.back() + std::hypot(_vProfile[i].x - _vProfile[i - 1].x, _vProfile[i].y - _vProfile[i - 1].y));
+		}
+
+		// The leading edge ends the first surface and is not repeated at the start of the second
+		size_t segment = 0;
+		for (size_t j = (surface == 0) ? 0 : 1; j < perSurface; j++)
+		{
+			const GLfloat target = arc.back() * 0.5f * (1.0f - std::cos(PI * (GLfloat)j / (GLfloat)(perSurface - 1)));
+			while (segment + 2 < arc.size() && arc[segment + 1] < target)
+			{
+				segment++;
+			}
+			const size_t next = std::min(segment + 1, arc.size() - 1);
+			const GLfloat segmentLength = arc[next] - arc[segment];
+			const GLfloat t = (segmentLength > 0.0f) ? glm::clamp((target - arc[segment]) / segmentLength, 0.0f, 1.0f) : 0.0f;
+			const VertexAttribute& a = _vProfile[first + segment];
+			const VertexAttribute& b = _vProfile[first + next];
+			VertexAttribute point = { a.x + t * (b.x - a.x), a.y + t * (b.y - a.y), a.z + t * (b.z - a.z), glm::vec3(0.0f, 0.0f, 0.0f) };
+			_vResampled.push_back(point);
+		}
+	}
+	_vResampled.front() = _vProfile.front();
+	_vResampled[perSurface - 1] = _vProfile[leading];
+	_vResampled.back() = _vProfile.back();
+}
+
+// Resamples every station of a blade with ResampleCorresponding and registers the stations after the first to its
+// trailing edge and chord direction. Blending stations point by point only keeps the sections in place when all
+// of them share that frame; a station placed or turned differently from the root would slide and twist the
+// sections in between.
+inline void ResampleStations(const std::vector<std::vector<VertexAttribute>>& _vProfile, size_t _points, std::vector<std::vector<VertexAttribute>>& _vStation)
+{
+	_vStation.resize(_vProfile.size());
+	for (size_t i = 0; i < _vProfile.size(); i++)
+	{
+		ResampleCorresponding(_vProfile[i], _points, _vStation[i]);
+	}
+	if (_vStation.empty() || _vStation.front().empty())
+	{
+		return;
+	}
+	const std::vector<VertexAttribute>& vRoot = _vStation.front();
+	const glm::vec2 trailing(vRoot.front().x, vRoot.front().y);
+	const VertexAttribute& leading = vRoot[FindLeadingEdge(vRoot)];
+	for (size_t i = 1; i < _vStation.size(); i++)
+	{
+		RegisterProfile(_vStation[i], trailing, glm::vec2(leading.x, leading.y) - trailing);
+	}
+}
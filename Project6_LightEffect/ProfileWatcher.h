@@ -0,0 +1,123 @@
+#pragma once
+
+// Std. Includes
+#include <chrono>
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <system_error>
+
+#ifdef __linux__
+#include <sys/inotify.h>
+#include <unistd.h>
+#include <cerrno>
+#include <climits>
+#endif
+
+// Notices when a profile file is rewritten. On Linux the containing directory is watched with inotify
+// (editors often save through a rename, which a watch on the file itself would lose); other platforms
+// fall back to polling the modification time. HasChanged() never blocks, so it can be called every frame.
+class ProfileWatcher
+{
+public:
+	ProfileWatcher() : inotifyFd(-1), watchFd(-1), lastPoll(std::chrono::steady_clock::now())
+	{
+	}
+
+	~ProfileWatcher()
+	{
+		this->Close();
+	}
+
+	ProfileWatcher(const ProfileWatcher&) = delete;
+	ProfileWatcher& operator=(const ProfileWatcher&) = delete;
+
+	bool Watch(const char *_filePath)
+	{
+		this->Close();
+		std::filesystem::path path(_filePath);
+		this->fileName = path.filename().string();
+		std::error_code ec;
+		this->lastWriteTime = std::filesystem::last_write_time(path, ec);
+		this->filePath = path;
+#ifdef __linux__
+		std::string directory = path.has_parent_path() ? path.parent_path().string() : std::string(".");
+		this->inotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+		if (this->inotifyFd >= 0)
+		{
+			// In-place saves end with IN_CLOSE_WRITE and atomic saves with IN_MOVED_TO; IN_CREATE would fire before the
+			// writer has filled the file and reload a partial profile
+			this->watchFd = inotify_add_watch(this->inotifyFd, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO);
+		}
+		if (this->watchFd < 0)
+		{
+			std::cout << "ERROR::WATCHER::INOTIFY_NOT_AVAILABLE " << directory << ", polling instead" << std::endl;
+			this->Close();
+		}
+#endif
+		return true;
+	}
+
+	void Close()
+	{
+#ifdef __linux__
+		if (this->inotifyFd >= 0)
+		{
+			close(this->inotifyFd);
+		}
+#endif
+		this->inotifyFd = -1;
+		this->watchFd = -1;
+	}
+
+	// True if the file was written since the last call. Bursts of events from one save are coalesced.
+	bool HasChanged()
+	{
+		bool changed = false;
+#ifdef __linux__
+		if (this->inotifyFd >= 0)
+		{
+			alignas(inotify_event) char buffer[4096];
+			for (;;)
+			{
+				ssize_t length = read(this->inotifyFd, buffer, sizeof(buffer));
+				if (length <= 0)
+				{
+					break;
+				}
+				for (char *p = buffer; p < buffer + length; p += sizeof(inotify_event) + ((inotify_event *)p)->len)
+				{
+					const inotify_event *event = (const inotify_event *)p;
+					if (event->len != 0 && this->fileName == event->name)
+					{
+						changed = true;
+					}
+				}
+			}
+			return changed;
+		}
+#endif
+		// Polling fallback, throttled so a per-frame call stays cheap
+		auto now = std::chrono::steady_clock::now();
+		if (now - this->lastPoll < std::chrono::milliseconds(250))
+		{
+			return false;
+		}
+		this->lastPoll = now;
+		std::error_code ec;
+		std::filesystem::file_time_type writeTime = std::filesystem::last_write_time(this->filePath, ec);
+		if (!ec && writeTime != this->lastWriteTime)
+		{
+			this->lastWriteTime = writeTime;
+			changed = true;
+		}
+		return changed;
+	}
+
+private:
+	std::filesystem::path filePath;
+	std::string fileName;
+	int inotifyFd, watchFd;
+	std::filesystem::file_time_type lastWriteTime;
+	std::chrono::steady_clock::time_point lastPoll;
+};
@@ -0,0 +1,260 @@
+#pragma once
+
+// Std. Includes
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+// GL Includes
+#include <GL/glew.h>
+
+#include <glm/glm.hpp>
+
+// Other includes
+#include "VertexAttribute.h"
+#include "LoftEngine.h"
+#include "Shader.h"
+
+// One propeller variant of a design sweep
+struct PropellerParams
+{
+	GLuint bladeCount;
+	GLfloat hubRadius;
+	GLfloat scaleOffset;	// Section k is scaled by log(k + scaleOffset)
+	GLfloat sectionSpacing;	// and placed at z * sectionSpacing * k
+	GLuint sections;	// FOILMAX
+};
+
+// Every combination of the listed values, blade count varying slowest
+struct PropellerGrid
+{
+	std::vector<GLuint> vBladeCount;
+	std::vector<GLfloat> vHubRadius;
+	std::vector<GLfloat> vScaleOffset;
+	std::vector<GLfloat> vSectionSpacing;
+	std::vector<GLuint> vSections;
+
+	std::vector<PropellerParams> Expand() const
+	{
+		std::vector<PropellerParams> vParams;
+		for (GLuint bladeCount : vBladeCount)
+			for (GLfloat hubRadius : vHubRadius)
+				for (GLfloat scaleOffset : vScaleOffset)
+					for (GLfloat sectionSpacing : vSectionSpacing)
+						for (GLuint sections : vSections)
+						{
+							PropellerParams params = { bladeCount, hubRadius, scaleOffset, sectionSpacing, sections };
+							vParams.push_back(params);
+						}
+		return vParams;
+	}
+};
+
+// Where one propeller lives in the sweep arena. Its indices are relative to vertexOffset, so a viewer can upload
+// the whole arena once and draw any variant with glDrawElementsBaseVertex, as LodChain does.
+struct PropellerEntry
+{
+	PropellerParams params;
+	size_t vertexOffset;
+	size_t vertexCount;
+	size_t indexOffset;
+	size_t indexCount;
+};
+
+// Header of a sweep file written by PropellerSweep::Write, followed by the entry table, the vertices and the indices
+struct PropellerSweepHeader
+{
+	uint32_t magic;
+	uint32_t version;
+	uint64_t entryCount;
+	uint64_t vertexCount;
+	uint64_t indexCount;
+};
+
+// A PropellerEntry as stored in a sweep file: fixed-width fields and explicit padding, so the table has the same
+// layout on every platform and no uninitialized bytes
+struct PropellerSweepEntry
+{
+	uint32_t bladeCount;
+	float hubRadius;
+	float scaleOffset;
+	float sectionSpacing;
+	uint32_t sections;
+	uint32_t padding;	// 0, keeps the offsets 8-byte aligned
+	uint64_t vertexOffset;
+	uint64_t vertexCount;
+	uint64_t indexOffset;
+	uint64_t indexCount;
+};
+static_assert(sizeof(PropellerSweepEntry) == 56, "PropellerSweepEntry must not be padded by the compiler");
+
+const uint32_t PROPELLER_SWEEP_MAGIC = 0x57535250;	// "PRSW"
+const uint32_t PROPELLER_SWEEP_VERSION = 3;	// 2: VertexAttribute carries span, 3: fixed-width entry table
+
+// Builds whole propellers (hub plus blades placed around it, as Draw places them) for a list of parameter sets
+// without any GL context or Shader object. Mesh sizes follow from the parameters alone, so the arena is laid out
+// up front and the workers write their propellers straight into disjoint ranges of it, pulling the next variant
+// from a shared counter.
+class PropellerSweep
+{
+public:
+	std::vector<VertexAttribute> vVertex;
+	std::vector<GLuint> vIndices;
+	std::vector<PropellerEntry> vEntry;
+
+	static const size_t HUBSTEP = 10;	// Degrees per hub segment, as MakeHub
+
+	PropellerSweep() : totalSeconds(0.0), threadCount(0)
+	{
+	}
+
+	// _threadCount = 0 uses one worker per hardware thread
+	void Generate(const std::vector<VertexAttribute>& _vProfile, const std::vector<PropellerParams>& _vParams, unsigned _threadCount = 0)
+	{
+		auto start = std::chrono::steady_clock::now();
+		const size_t points = _vProfile.size();
+		const size_t hubSegments = 360 / HUBSTEP;
+
+		// 1. Lay out the arena
+		vEntry.resize(_vParams.size());
+		size_t vertexTotal = 0, indexTotal = 0;
+		for (size_t i = 0; i < _vParams.size(); i++)
+		{
+			const PropellerParams& params = _vParams[i];
+			size_t bladeVertices = (points < 2) ? 0 : ((size_t)params.sections + 1) * points;
+			size_t bladeIndices = (points < 2) ? 0 : (size_t)params.sections * (points - 1) * 6;
+			PropellerEntry entry = { params, vertexTotal, 2 * hubSegments + params.bladeCount * bladeVertices,
+				indexTotal, 6 * hubSegments + params.bladeCount * bladeIndices };
+			vEntry[i] = entry;
+			vertexTotal += entry.vertexCount;
+			indexTotal += entry.indexCount;
+		}
+		vVertex.resize(vertexTotal);
+		vIndices.resize(indexTotal);
+
+		// 2. Build every propeller into its range
+		this->threadCount = (_threadCount != 0) ? _threadCount : std::max(1u, std::thread::hardware_concurrency());
+		this->threadCount = std::min<unsigned>(this->threadCount, std::max<size_t>(vEntry.size(), 1));
+		std::atomic<size_t> nextEntry(0);
+		RunWorkers([&]()
+		{
+			LoftEngine loft;
+			loft.SetProfile(_vProfile);
+			std::vector<VertexAttribute> vBlade, vHub;
+			std::vector<GLuint> vHubIndices;
+			for (size_t i = nextEntry++; i < vEntry.size(); i = nextEntry++)
+			{
+				const PropellerEntry& entry = vEntry[i];
+				VertexAttribute* vertex = &vVertex[entry.vertexOffset];
+				GLuint* index = vIndices.data() + entry.indexOffset;
+
+				vHub.clear();
+				vHubIndices.clear();
+				Shader::BuildHub(entry.params.hubRadius, HUBSTEP, vHub, vHubIndices);
+				std::copy(vHub.begin(), vHub.end(), vertex);
+				index = std::copy(vHubIndices.begin(), vHubIndices.end(), index);
+				GLuint base = (GLuint)vHub.size();
+				vertex += vHub.size();
+
+				if (points < 2)
+				{
+					continue;
+				}
+				loft.SetLaw(entry.params.scaleOffset, entry.params.sectionSpacing);
+				loft.Build(entry.params.sections);
+				loft.Interleave(vBlade);
+				for (GLuint blade = 0; blade < entry.params.bladeCount; blade++)
+				{
+					// Rotate about the hub axis after moving the blade root out to the hub radius
+					GLfloat angle = 2.0f * 3.14159265f * blade / entry.params.bladeCount;
+					GLfloat c = std::cos(angle), s = std::sin(angle);
+					for (const VertexAttribute& source : vBlade)
+					{
+						GLfloat x = source.x + entry.params.hubRadius;
+						vertex->x = c * x - s * source.y;
+						vertex->y = s * x + c * source.y;
+						vertex->z = source.z;
+						vertex->normal = glm::vec3(c * source.normal.x - s * source.normal.y, s * source.normal.x + c * source.normal.y, source.normal.z);
+						vertex->span = source.span;
+						vertex++;
+					}
+					for (GLuint bladeIndex : loft.indices)
+					{
+						*index++ = base + bladeIndex;
+					}
+					base += (GLuint)vBlade.size();
+				}
+			}
+		});
+
+		this->totalSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	}
+
+	// Writes the entry table and the arena in one file; returns false if it could not be written
+	bool Write(const char *_path) const
+	{
+		std::ofstream file(_path, std::ios::binary);
+		if (!file)
+		{
+			std::cout << "ERROR::SWEEP::FILE_NOT_SUCCESFULLY_WRITTEN " << _path << std::endl;
+			return false;
+		}
+		PropellerSweepHeader header = { PROPELLER_SWEEP_MAGIC, PROPELLER_SWEEP_VERSION, vEntry.size(), vVertex.size(), vIndices.size() };
+		file.write((const char*)&header, sizeof(header));
+		std::vector<PropellerSweepEntry> vStored(vEntry.size());
+		for (size_t i = 0; i < vEntry.size(); i++)
+		{
+			const PropellerEntry& entry = vEntry[i];
+			PropellerSweepEntry stored = { entry.params.bladeCount, entry.params.hubRadius, entry.params.scaleOffset, entry.params.sectionSpacing,
+				entry.params.sections, 0, entry.vertexOffset, entry.vertexCount, entry.indexOffset, entry.indexCount };
+			vStored[i] = stored;
+		}
+		file.write((const char*)vStored.data(), sizeof(PropellerSweepEntry) * vStored.size());
+		file.write((const char*)vVertex.data(), sizeof(VertexAttribute) * vVertex.size());
+		file.write((const char*)vIndices.data(), sizeof(GLuint) * vIndices.size());
+		if (!file)
+		{
+			std::cout << "ERROR::SWEEP::FILE_NOT_SUCCESFULLY_WRITTEN " << _path << std::endl;
+			return false;
+		}
+		return true;
+	}
+
+	void Report(std::ostream& _out) const
+	{
+		size_t bytes = sizeof(VertexAttribute) * vVertex.size() + sizeof(GLuint) * vIndices.size();
+		_out << vEntry.size() << " propellers, " << vVertex.size() << " vertices, " << vIndices.size() << " indices ("
+			<< bytes / (1024.0 * 1024.0) << " MB) on " << this->threadCount << " threads in " << this->totalSeconds * 1000.0 << " ms: "
+			<< vEntry.size() / this->totalSeconds << " meshes/s, " << vVertex.size() / this->totalSeconds / 1.0e6 << " Mvertices/s" << std::endl;
+	}
+
+	double GetTotalSeconds() const
+	{
+		return this->totalSeconds;
+	}
+
+private:
+	double totalSeconds;
+	unsigned threadCount;
+
+	template <class Work>
+	void RunWorkers(Work _work)
+	{
+		std::vector<std::thread> vThread;
+		for (unsigned i = 1; i < this->threadCount; i++)
+		{
+			vThread.emplace_back(_work);
+		}
+		_work();
+		for (std::thread& thread : vThread)
+		{
+			thread.join();
+		}
+	}
+};
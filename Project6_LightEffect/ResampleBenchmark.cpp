@@ -0,0 +1,64 @@
+// Vertex count against error of the curvature-adaptive profile resampler.
+// Usage: ResampleBenchmark [profile.out] [sections]
+// Prints, per tolerance, the resampled point count, the measured error against the original points and the
+// vertex count of the resulting loft, next to the error the original sampling already has. Then the same for
+// sampling a B-spline fitted once to the profile, with its control point count and evaluation time.
+#include <iostream>
+#include <vector>
+#include <chrono>
+#include <cstdlib>
+
+// GLEW
+#include <GL/glew.h>
+
+// GLM
+#include <glm/glm.hpp>
+
+// Other includes
+#include "VertexAttribute.h"
+#include "AirfoilLoader.h"
+#include "ProfileResampler.h"
+#include "SplineProfile.h"
+
+int main(int argc, char *argv[])
+{
+	const char *filePath = (argc > 1) ? argv[1] : "foil_spline.out";
+	size_t sections = (argc > 2) ? std::atoi(argv[2]) + 1 : 11;
+
+	std::vector<VertexAttribute> vProfile, vResampled;
+	if (!LoadOutProfile(filePath, vProfile))
+	{
+		return EXIT_FAILURE;
+	}
+
+	const GLfloat tolerances[] = { 1e-2f, 3e-3f, 1e-3f, 3e-4f, 1e-4f, 3e-5f, 1e-5f };
+	for (GLfloat tolerance : tolerances)
+	{
+		auto start = std::chrono::steady_clock::now();
+		ResampleResult result = ResampleProfile(vProfile, tolerance, vResampled);
+		double milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+		if (tolerance == tolerances[0])
+		{
+			std::cout << filePath << ": " << result.inputPoints << " points, original sampling error " << result.inputError
+				<< ", loft " << result.inputPoints * sections << " vertices" << std::endl;
+		}
+		std::cout << "tolerance " << tolerance << ": " << result.outputPoints << " points, max error " << result.maxError
+			<< ", loft " << result.outputPoints * sections << " vertices ("
+			<< (double)result.inputPoints / result.outputPoints << "x fewer), " << milliseconds << " ms" << std::endl;
+	}
+
+	for (GLfloat tolerance : tolerances)
+	{
+		auto start = std::chrono::steady_clock::now();
+		SplineProfile spline;
+		GLfloat fitError = spline.Fit(vProfile, 0.5f * tolerance);
+		auto fitted = std::chrono::steady_clock::now();
+		GLfloat deviation = spline.Sample(tolerance - 0.5f * tolerance, vResampled);
+		auto sampled = std::chrono::steady_clock::now();
+		std::cout << "spline tolerance " << tolerance << ": " << spline.controls.size() << " control points (" << spline.GetBytes() << " bytes), fit error "
+			<< fitError << " in " << std::chrono::duration<double, std::milli>(fitted - start).count() << " ms, " << vResampled.size()
+			<< " points, max deviation " << deviation << " (" << fitError + deviation << " from the profile) in " << std::chrono::duration<double, std::milli>(sampled - fitted).count() << " ms" << std::endl;
+	}
+
+	return EXIT_SUCCESS;
+}
@@ -8,60 +8,53 @@
 #include <vector>
 #include <GL/glew.h>
 
-typedef struct _vertexAttri
-{
-	GLfloat x, y, z;
-	glm::vec3 normal;
-}VertexAttribute;
+#include "VertexAttribute.h"
+#include "AirfoilLoader.h"
+#include "AirfoilCache.h"
+#include "LoftEngine.h"
+#include "ProfileResampler.h"
+#include "MeshLod.h"
+#include "VertexCache.h"
+#include "VertexWeld.h"
+#include "DirtyBuffer.h"
+#include "NacaProfile.h"
+#include "SplineProfile.h"
+#include "NormalEngine.h"
 
 class Shader
 {
 private:
 	std::vector<VertexAttribute> vVertexT;
 
-	template <class Container>
-	void split(const std::string& str, Container& cont, char delim = '\n')
+	NormalEngine foilNormals;	// Keeps its adjacency between sweep frames of the same size
+
+	// Smooth normals: the average of the unit face normals around each vertex
+	void CalculateNormal(std::vector<VertexAttribute>& _vVertex, std::vector<GLuint>& _vIndices)
 	{
-		std::stringstream ss(str);
-		std::string token;
-		while (std::getline(ss, token, delim)) {
-			cont.push_back(token);
-		}
+		this->foilNormals.SetThreadCount(0);
+		this->foilNormals.Compute(_vVertex, _vIndices, NORMAL_WEIGHT_UNIT);
 	}
 
-	void CalculateNormal(std::vector<VertexAttribute>& _vVertex, std::vector<GLuint>& _vIndices)
+	// Connects the section just appended to _vVertex with the one before it
+	static void AppendSectionIndices(const std::vector<VertexAttribute>& _vVertex, std::vector<GLuint>& _vIndices, const GLuint _stride)
 	{
-		std::vector<int> nbSeen;
-		nbSeen.resize(_vVertex.size(), 0);
-		for (int i = 0; i < _vIndices.size() - 2; i += 3) {
-			GLuint ia = _vIndices[i];
-			GLuint ib = _vIndices[i + 1];
-			GLuint ic = _vIndices[i + 2];
-			glm::vec3 normal = glm::normalize(glm::cross(
-				glm::vec3(_vVertex[ic].x, _vVertex[ic].y, _vVertex[ic].z) - glm::vec3(_vVertex[ib].x, _vVertex[ib].y, _vVertex[ib].z),
-				glm::vec3(_vVertex[ia].x, _vVertex[ia].y, _vVertex[ia].z) - glm::vec3(_vVertex[ib].x, _vVertex[ib].y, _vVertex[ib].z)));
-
-			int v[3];  v[0] = ia;  v[1] = ib;  v[2] = ic;
-			for (int j = 0; j < 3; j++) {
-				GLushort cur_v = v[j];
-				nbSeen[cur_v]++;
-				if (nbSeen[cur_v] == 1) {
-					_vVertex[cur_v].normal = normal;
-				}
-				else {
-					// The Method of Phong Shading
-					_vVertex[cur_v].normal.x = _vVertex[cur_v].normal.x * (1.0 - 1.0 / nbSeen[cur_v]) + normal.x * 1.0 / nbSeen[cur_v];
-					_vVertex[cur_v].normal.y = _vVertex[cur_v].normal.y * (1.0 - 1.0 / nbSeen[cur_v]) + normal.y * 1.0 / nbSeen[cur_v];
-					_vVertex[cur_v].normal.z = _vVertex[cur_v].normal.z * (1.0 - 1.0 / nbSeen[cur_v]) + normal.z * 1.0 / nbSeen[cur_v];
-					_vVertex[cur_v].normal = glm::normalize(_vVertex[cur_v].normal);
-				}
-			}
+		for (size_t ii = _vVertex.size() - 1; ii > _vVertex.size() - _stride; ii--)
+		{
+			_vIndices.push_back((GLuint)ii);
+			_vIndices.push_back((GLuint)ii - 1);
+			_vIndices.push_back((GLuint)ii - 1 - _stride);
+
+			_vIndices.push_back((GLuint)ii);
+			_vIndices.push_back((GLuint)ii - 1 - _stride);
+			_vIndices.push_back((GLuint)ii - _stride);
 		}
 	}
 
 public:
 	std::vector<VertexAttribute> vFoilVertex, vHubVertex;
 	std::vector<GLuint> vFoilIndices, vHubIndices;
+	std::vector<GLuint> vFoilStripIndices;	// Same foil triangles as strips joined by LoftEngine::RESTARTINDEX
+	bool foilInLoftOrder = false;	// The foil is MakeFoil's loft of the base profile in generation order, so ResizeFoil can edit it in place
 	GLfloat vertices[216] =
 	{
 		-0.5f, -0.5f, -0.5f,  0.0f,  0.0f, -1.0f,
@@ -193,146 +186,379 @@ public:
 
 	bool LoadOutFile(const char * _filePath)
 	{
-		// 1. Retrieve the vertex/fragment source code from filePath
-		std::string vertexCode;
-		std::ifstream vShaderFile;
-		// ensures ifstream objects can throw exceptions:
-		vShaderFile.exceptions(std::ifstream::badbit);
-		try
-		{
-			// Open files
-			vShaderFile.open(_filePath);
-			std::stringstream vShaderStream;
-			// Read file's buffer contents into streams
-			vShaderStream << vShaderFile.rdbuf();
-			// close file handlers
-			vShaderFile.close();
-			// Convert stream into string
-			vertexCode = vShaderStream.str();
-		}
-		catch (std::ifstream::failure e)
+		// Map the binary cache of the .out file, converting the text on first load
+		profileSpline.Clear();
+		if (!LoadOutProfileCached(_filePath, vVertexT))
 		{
 			std::cout << "ERROR::SHADER::.out_FILE_NOT_SUCCESFULLY_READ" << std::endl;
 			return GL_FALSE;
 		}
 
-		std::vector<std::string> vContainer;
-		split(vertexCode, vContainer);
+		return GL_TRUE;
+	}
 
-		size_t verticesIndex = 0;
-		float firstX = 0.0f, firstY = 0.0f;
-		for each (std::string var in vContainer)
+	// Generates the base profile from a NACA 4- or 5-digit code instead of reading a .out file, placed at
+	// _trailingEdge and _chord (by default where LoadOutFile puts foil_spline.out)
+	bool LoadNacaProfile(const char * _code, const size_t _points, const glm::vec2 _trailingEdge = OUT_TRAILING_EDGE, const glm::vec2 _chord = OUT_CHORD)
+	{
+		std::vector<VertexAttribute> vProfile;
+		if (!MakeNacaProfile(_code, _points, vProfile, _trailingEdge, _chord))
 		{
-			std::vector<std::string> coorSet;
-			split(var, coorSet, '\t');
+			std::cout << "ERROR::SHADER::NACA_PROFILE_NOT_GENERATED" << std::endl;
+			return GL_FALSE;
+		}
+		vVertexT.swap(vProfile);
+		profileSpline.Clear();
+		return GL_TRUE;
+	}
 
-			if (coorSet.size() == 1)
-			{
-				if (verticesIndex != 0)
-				{
-					std::cout << "ERROR::SHADER::VERTEX_SIZE_CHANGED" << std::endl;
-					return GL_FALSE;
-				}
-				vVertexT.reserve(std::stoi(coorSet[0]));
-			}
-			else
-			{
-				if (verticesIndex == 0)
-				{
-					firstX = std::stof(coorSet[0]);
-					firstY = std::stof(coorSet[1]);
-				}
-				double x = std::stof(coorSet[0]) - firstX;
-				double y = std::stof(coorSet[1]) - firstY;
-				double z = 1.0f;
+	// The base profile as a spline, once FitProfileSpline has run. ResampleProfile and the level of detail chain
+	// then sample it directly instead of refitting the points.
+	SplineProfile profileSpline;
 
-				coorSet.clear();
+	// Fits the base profile with a B-spline of at most _maxControls control points within _tolerance
+	void FitProfileSpline(const GLfloat _tolerance, const size_t _maxControls)
+	{
+		GLfloat error = profileSpline.Fit(vVertexT, _tolerance, _maxControls);
+		std::cout << "Profile spline: " << vVertexT.size() << " points (" << sizeof(VertexAttribute) * vVertexT.size() << " bytes) -> "
+			<< profileSpline.controls.size() << " control points (" << profileSpline.GetBytes() << " bytes), max error " << error << std::endl;
+	}
 
-				if (verticesIndex++ < vVertexT.capacity())
-				{
-					VertexAttribute vVA = { x, y, z, glm::vec3(0.0f, 0.0f, 0.0f) };
-					vVertexT.push_back(vVA);
-				}
-			}
+	// Replaces the base profile with a curvature-adaptive resampling within _tolerance (in profile units),
+	// so MakeFoil lofts the reduced profile
+	void ResampleProfile(const GLfloat _tolerance)
+	{
+		if (!profileSpline.Empty())
+		{
+			size_t inputPoints = vVertexT.size();
+			GLfloat deviation = profileSpline.Sample(_tolerance, vVertexT);
+			std::cout << "Profile sampled from spline: " << inputPoints << " -> " << vVertexT.size() << " points, max deviation " << deviation << std::endl;
+			return;
 		}
+		std::vector<VertexAttribute> vResampled;
+		ResampleResult result = ::ResampleProfile(vVertexT, _tolerance, vResampled);
+		vVertexT.swap(vResampled);
+		std::cout << "Profile resampled: " << result.inputPoints << " -> " << result.outputPoints << " points, max error "
+			<< result.maxError << " (original sampling " << result.inputError << ")" << std::endl;
+	}
 
+	// The base profile read by LoadOutFile, before any loft
+	const std::vector<VertexAttribute>& GetProfile() const
+	{
+		return vVertexT;
+	}
+
+	// Replaces the base profile, e.g. with a reloaded one, without touching the meshes built from the old one.
+	// _spline is the spline the profile was sampled from, if any.
+	void SetProfile(const std::vector<VertexAttribute>& _vProfile, const SplineProfile& _spline = SplineProfile())
+	{
+		vVertexT = _vProfile;
+		profileSpline = _spline;
+	}
+
+	// Root-to-tip station profiles; when set, MakeFoil blends them instead of lofting the base profile alone
+	LoftStations foilStations;
+
+	// Makes _vProfile the blade stations at span fractions _vSpan, each resampled to _points corresponding points
+	// and registered to the trailing edge and chord direction of the first (ResampleStations).
+	// The first station becomes the base profile, so the strips, the procedural loft and ResizeFoil stay consistent.
+	bool SetStations(const std::vector<std::vector<VertexAttribute>>& _vProfile, const std::vector<GLfloat>& _vSpan, const size_t _points)
+	{
+		LoftStations stations;
+		stations.vSpan = _vSpan;
+		::ResampleStations(_vProfile, _points, stations.vProfile);
+		LoftEngine loft;
+		if (!loft.SetStations(stations))
+		{
+			std::cout << "ERROR::SHADER::STATIONS_NOT_SET" << std::endl;
+			return GL_FALSE;
+		}
+		foilStations = std::move(stations);
+		vVertexT = foilStations.vProfile.front();
+		profileSpline.Clear();
 		return GL_TRUE;
 	}
 
 	void MakeFoil(const GLuint _FOILMAX)
+	{
+		BuildFoil(vVertexT, _FOILMAX, vFoilVertex, vFoilIndices, 1, foilStations.Empty() ? nullptr : &foilStations);
+		LoftEngine::StripIndices(vVertexT.empty() ? 0 : vFoilVertex.size() / vVertexT.size(), vVertexT.size(), vFoilStripIndices);
+		foilInLoftOrder = true;
+	}
+
+	// Changes the foil to _FOILMAX + 1 sections in place. Sections that stay keep their vertices and triangles:
+	// growing lofts and appends only the new sections, shrinking only drops the tail, and in both cases the normals
+	// of the section next to the change are rewritten since its span neighbour changed. The element ranges that
+	// changed are added to _vertices, _indices and _strips. A foil that is not in loft order, or that blends
+	// stations (whose span fractions move with _FOILMAX), is rebuilt whole.
+	void ResizeFoil(const GLuint _FOILMAX, DirtyRange& _vertices, DirtyRange& _indices, DirtyRange& _strips)
+	{
+		const size_t points = vVertexT.size();
+		const size_t oldSections = (points == 0) ? 0 : vFoilVertex.size() / points;
+		const size_t newSections = (size_t)_FOILMAX + 1;
+		if (!foilInLoftOrder || !foilStations.Empty() || oldSections < 2 || points < 2)
+		{
+			MakeFoil(_FOILMAX);
+			_vertices.Add(0, vFoilVertex.size());
+			_indices.Add(0, vFoilIndices.size());
+			_strips.Add(0, vFoilStripIndices.size());
+			return;
+		}
+		if (newSections == oldSections)
+		{
+			return;
+		}
+
+		const size_t firstSection = std::min(oldSections, newSections) - 1;
+		LoftEngine loft;
+		loft.SetProfile(vVertexT);
+		loft.Build(_FOILMAX, 1, firstSection);
+		loft.Interleave(vFoilVertex, firstSection * points);
+		_vertices.Add(firstSection * points, vFoilVertex.size());
+
+		const size_t keptIndices = (oldSections - 1) * (points - 1) * 6;
+		vFoilIndices.resize(loft.indices.size());
+		if (loft.indices.size() > keptIndices)
+		{
+			std::copy(loft.indices.begin() + keptIndices, loft.indices.end(), vFoilIndices.begin() + keptIndices);
+			_indices.Add(keptIndices, vFoilIndices.size());
+		}
+
+		// Strips of the kept section pairs are unchanged; the new ones start with the restart before them
+		const size_t keptStrips = (oldSections - 1) * (2 * points + 1) - 1;
+		LoftEngine::StripIndices(newSections, points, vFoilStripIndices);
+		if (vFoilStripIndices.size() > keptStrips)
+		{
+			_strips.Add(keptStrips, vFoilStripIndices.size());
+		}
+	}
+
+	// Lofts _vProfile into _FOILMAX + 1 sections, replacing the contents of _vVertex and _vIndices.
+	// With _stations the sections blend those instead. The normals come out of the loft itself.
+	// Needs no GL context, so a profile reload can run it off the render thread.
+	static void BuildFoil(const std::vector<VertexAttribute>& _vProfile, const GLuint _FOILMAX, std::vector<VertexAttribute>& _vVertex, std::vector<GLuint>& _vIndices, const GLuint _sectionStep = 1, const LoftStations* _stations = nullptr)
 	{
 		// Make an airfoil with differentent Z coordinates.
-		for each (VertexAttribute var in vVertexT)
+		LoftEngine loft;
+		if (_stations == nullptr || !loft.SetStations(*_stations))
 		{
-			vFoilVertex.push_back(var);
+			loft.SetProfile(_vProfile);
 		}
-		for (size_t foilNum = 1; foilNum <= _FOILMAX; foilNum++)
+		loft.Build(_FOILMAX, _sectionStep);
+		loft.Interleave(_vVertex);
+		_vIndices.swap(loft.indices);
+	}
+
+	// Opt-in pass over the current foil and hub meshes (generated or loaded) that merges vertices closer than
+	// _epsilon and drops the triangles left without area, see WeldVertices
+	void WeldMeshes(const GLfloat _epsilon, const GLfloat _normalCosine = -1.0f)
+	{
+		std::vector<GLuint> vRemap = WeldMesh("Foil", vFoilVertex, vFoilIndices, _epsilon, _normalCosine);
+		RemapIndices(vFoilStripIndices, vRemap, LoftEngine::RESTARTINDEX);
+		foilInLoftOrder = false;
+		WeldMesh("Hub", vHubVertex, vHubIndices, _epsilon, _normalCosine);
+	}
+
+	// Recomputes the foil normals from its faces, kept sharp where they turn by more than _creaseDegrees (the
+	// trailing edge): the vertices on such an edge are split, one copy per smooth side, in the list and the strips
+	// alike. The hub is left alone: it is an open cylinder with exact radial normals, which ResizeHub builds its
+	// positions from.
+	void CreaseNormals(const GLfloat _creaseDegrees, const NormalWeight _weight = NORMAL_WEIGHT_ANGLE)
+	{
+		CreaseMesh("Foil", vFoilVertex, vFoilIndices, _creaseDegrees, _weight, &vFoilStripIndices, LoftEngine::RESTARTINDEX);
+		foilInLoftOrder = false;
+	}
+
+	// Opt-in pass over the current foil and hub meshes (generated or loaded) that reorders their triangles
+	// for the post-transform cache and their vertices for fetch locality
+	void OptimizeMeshes(const size_t _cacheSize = 16)
+	{
+		std::vector<GLuint> vRemap = OptimizeMesh("Foil", vFoilVertex, vFoilIndices, _cacheSize);
+		RemapIndices(vFoilStripIndices, vRemap, LoftEngine::RESTARTINDEX);
+		foilInLoftOrder = false;
+		OptimizeMesh("Hub", vHubVertex, vHubIndices, _cacheSize);
+	}
+
+	// Lofts a sweep file section by section while it is streamed from disk, replacing the foil.
+	// Section k is placed at the z the MakeFoil loft uses for foil k and gets span k; all sections must share one
+	// point count. The loft is built aside and only swapped in once the whole file has been read, so a failed load
+	// keeps the current foil.
+	bool LoadOutSweep(const char * _filePath)
+	{
+		std::vector<VertexAttribute> vVertex;
+		std::vector<GLuint> vIndices;
+		GLuint stride = 0;
+		bool sameSize = true;
+		bool read = ForEachOutSection(_filePath, [&](size_t _sectionIndex, std::vector<VertexAttribute>& _vSection)
 		{
-			std::vector<VertexAttribute> vVertexAttributeTheOtherZ = vVertexT;
-			for (VertexAttribute& var : vVertexAttributeTheOtherZ)
+			if (_sectionIndex == 0)
 			{
-				GLfloat factor = glm::log((GLfloat)foilNum + 2.5f);
-				var.x = var.x * factor;
-				var.y = var.y * factor;
-				var.z = var.z * 2.5f * foilNum;
+				stride = _vSection.size();
 			}
-			for each (VertexAttribute var in vVertexAttributeTheOtherZ)
+			if (_vSection.empty() || _vSection.size() != stride)
 			{
-				vFoilVertex.push_back(var);
+				sameSize = false;
+				return false;
 			}
-			GLuint stride = vVertexAttributeTheOtherZ.size();
-			for (size_t ii = vFoilVertex.size() - 1; ii > vFoilVertex.size() - stride; ii--)
+			for (VertexAttribute& var : _vSection)
 			{
-				vFoilIndices.push_back((GLuint)ii);
-				vFoilIndices.push_back((GLuint)ii - 1);
-				vFoilIndices.push_back((GLuint)ii - 1 - stride);
-
-				vFoilIndices.push_back((GLuint)ii);
-				vFoilIndices.push_back((GLuint)ii - 1 - stride);
-				vFoilIndices.push_back((GLuint)ii - stride);
+				if (_sectionIndex != 0)
+				{
+					var.z = var.z * 2.5f * _sectionIndex;
+				}
+				var.span = (GLfloat)_sectionIndex;
+				vVertex.push_back(var);
 			}
-			vVertexAttributeTheOtherZ.clear();
-			vVertexAttributeTheOtherZ.shrink_to_fit();
+			if (_sectionIndex != 0)
+			{
+				AppendSectionIndices(vVertex, vIndices, stride);
+			}
+			return true;
+		});
+		if (!sameSize)
+		{
+			std::cout << "ERROR::SHADER::VERTEX_SIZE_CHANGED" << std::endl;
+			return GL_FALSE;
+		}
+		if (!read || vVertex.empty())
+		{
+			std::cout << "ERROR::SHADER::.out_FILE_NOT_SUCCESFULLY_READ" << std::endl;
+			return GL_FALSE;
 		}
 
-		CalculateNormal(vFoilVertex, vFoilIndices);
+		CalculateNormal(vVertex, vIndices);
+		vFoilVertex.swap(vVertex);
+		vFoilIndices.swap(vIndices);
+		LoftEngine::StripIndices(vFoilVertex.size() / stride, stride, vFoilStripIndices);
+		foilInLoftOrder = false;
+		return GL_TRUE;
 	}
 
 	void MakeHub(const GLfloat _RADIUS)
 	{
-		for (size_t theta = 0; theta < 360; theta += 10)
+		BuildHub(_RADIUS, 10, vHubVertex, vHubIndices);
+	}
+
+	// Builds the hub cylinder with one segment every _step degrees (_step should divide 360).
+	// Each vertex gets the exact radial normal of the cylinder, so there is no shading seam where the last segment wraps.
+	static void BuildHub(const GLfloat _RADIUS, const size_t _step, std::vector<VertexAttribute>& _vVertex, std::vector<GLuint>& _vIndices)
+	{
+		for (size_t theta = 0; theta < 360; theta += _step)
 		{
-			GLfloat x = _RADIUS * glm::cos(theta * 3.14f / 180);
-			GLfloat y = _RADIUS * glm::sin(theta * 3.14f / 180);
-			VertexAttribute hub = { x, y, 0.0f, glm::vec3(0.0f, 0.0f, 0.0f) };
-			vHubVertex.push_back(hub);
-			hub = { x, y, 30.0f, glm::vec3(0.0f, 0.0f, 0.0f) };
-			vHubVertex.push_back(hub);
+			GLfloat c = glm::cos(theta * 3.14f / 180);
+			GLfloat s = glm::sin(theta * 3.14f / 180);
+			VertexAttribute hub = { _RADIUS * c, _RADIUS * s, 0.0f, glm::vec3(c, s, 0.0f) };
+			_vVertex.push_back(hub);
+			hub = { _RADIUS * c, _RADIUS * s, 30.0f, glm::vec3(c, s, 0.0f) };
+			_vVertex.push_back(hub);
 		}
-		for (size_t i = 0; i < vHubVertex.size() - 1; i += 2)
+		for (size_t i = 0; i < _vVertex.size() - 1; i += 2)
 		{
-			vHubIndices.push_back(i + 2);
-			vHubIndices.push_back(i + 1);
-			vHubIndices.push_back(i);
+			if (i == _vVertex.size() - 2)
+			{
+				// The last segment wraps around to the first pair of vertices
+				_vIndices.push_back(0);
+				_vIndices.push_back(i + 1);
+				_vIndices.push_back(i);
+
+				_vIndices.push_back(1);
+				_vIndices.push_back(i + 1);
+				_vIndices.push_back(0);
+				break;
+			}
 
-			vHubIndices.push_back(i + 3);
-			vHubIndices.push_back(i + 1);
-			vHubIndices.push_back(i + 2);
+			_vIndices.push_back(i + 2);
+			_vIndices.push_back(i + 1);
+			_vIndices.push_back(i);
 
-			if (i == vHubVertex.size() - 2)
-			{
-				vHubIndices.push_back(0);
-				vHubIndices.push_back(i + 1);
-				vHubIndices.push_back(i);
+			_vIndices.push_back(i + 3);
+			_vIndices.push_back(i + 1);
+			_vIndices.push_back(i + 2);
+		}
+	}
 
-				vHubIndices.push_back(1);
-				vHubIndices.push_back(i + 1);
-				vHubIndices.push_back(0);
+	// Moves the hub vertices to radius _RADIUS. Only positions change; with exact radial normals every
+	// position is just the normal scaled by the radius, plus its z. The changed vertices are added to _vertices.
+	void ResizeHub(const GLfloat _RADIUS, DirtyRange& _vertices)
+	{
+		for (VertexAttribute& vertex : vHubVertex)
+		{
+			vertex.x = _RADIUS * vertex.normal.x;
+			vertex.y = _RADIUS * vertex.normal.y;
+		}
+		_vertices.Add(0, vHubVertex.size());
+	}
+
+	// Level of detail chains of the blade and the hub, see MakeLod
+	LodChain foilLod, hubLod;
+
+	// Builds _levels levels of the blade and the hub from the current base profile. Blade level l keeps every
+	// 2^l-th section and resamples the profile at _tolerance * 4^l (sampling the profile spline when there is one;
+	// blended stations keep their points, since they have to correspond); the hub doubles its angle step per level.
+	void MakeLod(const GLuint _FOILMAX, const GLfloat _RADIUS, const GLfloat _tolerance, const size_t _levels = 4)
+	{
+		BuildFoilLod(vVertexT, _FOILMAX, _tolerance, _levels, foilLod, profileSpline.Empty() ? nullptr : &profileSpline, foilStations.Empty() ? nullptr : &foilStations);
+		BuildHubLod(_RADIUS, _levels, hubLod);
+	}
 
+	static void BuildFoilLod(const std::vector<VertexAttribute>& _vProfile, const GLuint _FOILMAX, const GLfloat _tolerance, const size_t _levels, LodChain& _lod, const SplineProfile* _spline = nullptr, const LoftStations* _stations = nullptr)
+	{
+		_lod.Clear();
+		GLfloat profileRadius = 0.0f;
+		for (const VertexAttribute& var : _vProfile)
+		{
+			profileRadius = std::max(profileRadius, glm::length(glm::vec2(var.x, var.y)));
+		}
+
+		// A profile sampled from a spline is off the original points by the fit error as well, so each level's error
+		// includes it and the spline levels are sampled within what is left of their tolerance
+		const GLfloat fitError = (_spline != nullptr) ? _spline->fitError : 0.0f;
+		for (size_t level = 0; level < _levels; level++)
+		{
+			std::vector<VertexAttribute> vProfile = _vProfile;
+			GLfloat profileError = fitError;
+			const bool resample = (level != 0 && _stations == nullptr);
+			if (resample && _spline != nullptr)
+			{
+				const GLfloat levelTolerance = _tolerance * std::pow(4.0f, (GLfloat)level);
+				profileError += _spline->Sample(std::max(levelTolerance - fitError, 0.5f * levelTolerance), vProfile);
+			}
+			else if (resample)
+			{
+				profileError = ::ResampleProfile(_vProfile, _tolerance * std::pow(4.0f, (GLfloat)level), vProfile).maxError;
 			}
+
+			// Skipped sections are replaced by the straight blend of their neighbours; the log scale makes that inexact
+			const GLuint step = 1u << level;
+			GLfloat spanError = 0.0f;
+			for (GLuint foilNum = 0; foilNum <= _FOILMAX; foilNum++)
+			{
+				GLuint k0 = foilNum / step * step, k1 = std::min(k0 + step, _FOILMAX);
+				GLfloat t = (k1 == k0) ? 0.0f : (GLfloat)(foilNum - k0) / (k1 - k0);
+				GLfloat blended = glm::mix(LoftEngine::SectionScale(k0), LoftEngine::SectionScale(k1), t);
+				spanError = std::max(spanError, std::abs(LoftEngine::SectionScale(foilNum) - blended) * profileRadius);
+			}
+
+			std::vector<VertexAttribute> vVertex;
+			std::vector<GLuint> vIndices;
+			BuildFoil(vProfile, _FOILMAX, vVertex, vIndices, step, _stations);
+			_lod.AddLevel(vVertex, vIndices, profileError * LoftEngine::SectionScale(_FOILMAX) + spanError);
 		}
+	}
 
-		CalculateNormal(vHubVertex, vHubIndices);
+	static void BuildHubLod(const GLfloat _RADIUS, const size_t _levels, LodChain& _lod)
+	{
+		// Angle steps that divide the full turn: 36, 18, 9, 6 and 4 segments
+		const size_t steps[] = { 10, 20, 40, 60, 90 };
+		_lod.Clear();
+		for (size_t level = 0; level < _levels && level < sizeof(steps) / sizeof(steps[0]); level++)
+		{
+			std::vector<VertexAttribute> vVertex;
+			std::vector<GLuint> vIndices;
+			BuildHub(_RADIUS, steps[level], vVertex, vIndices);
+			// Sagitta of one segment against the true cylinder
+			_lod.AddLevel(vVertex, vIndices, _RADIUS * (1.0f - glm::cos(glm::radians(steps[level] * 0.5f))));
+		}
 	}
 
 	~Shader()
@@ -0,0 +1,406 @@
+#pragma once
+
+// Std. Includes
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+// GL Includes
+#include <GL/glew.h>
+
+#include <glm/glm.hpp>
+
+// Eigen (OpenGL_Dependency/ext/eigen)
+#include <Eigen/Dense>
+
+// Other includes
+#include "VertexAttribute.h"
+
+// A blade profile kept as a clamped NURBS curve over [0, 1] instead of as sampled points: control points with
+// weights and a knot vector, evaluated on demand at whatever resolution a level of detail asks for.
+// Fit turns a sampled profile (a .out file or a generated NACA section) into a few tens of control points;
+// its weights are all 1, but Evaluate handles any rational curve.
+class SplineProfile
+{
+public:
+	static const int MAXDEGREE = 5;
+	static const size_t BATCH = 64;	// Parameters evaluated together by Evaluate
+
+	int degree;
+	std::vector<GLfloat> knots;	// controls.size() + degree + 1 values, the first and last degree + 1 repeated
+	std::vector<glm::vec3> controls;	// x, y and the weight
+	GLfloat z;	// z of every profile point, as LoadOutFile gives it
+	GLfloat fitError;	// Largest distance of the fitted points from the curve, as Fit returned it
+
+	SplineProfile() : degree(3), z(1.0f), fitError(0.0f)
+	{
+	}
+
+	bool Empty() const
+	{
+		return this->controls.empty();
+	}
+
+	void Clear()
+	{
+		this->knots.clear();
+		this->controls.clear();
+		this->fitError = 0.0f;
+	}
+
+	size_t GetBytes() const
+	{
+		return sizeof(GLfloat) * this->knots.size() + sizeof(glm::vec3) * this->controls.size();
+	}
+
+	// Least-squares fit of a clamped B-spline of _degree through the profile points at their chord-length
+	// parameters. The end points are interpolated exactly, so a closed profile stays closed with its sharp
+	// trailing edge. Starting from knots that give every span the same number of points, the spans whose points
+	// are further than _tolerance from the curve are split at their median point and the fit is solved again,
+	// until every point is within _tolerance or _maxControls is reached. Returns the largest point distance.
+	GLfloat Fit(const std::vector<VertexAttribute>& _vProfile, const GLfloat _tolerance, const size_t _maxControls = 64, const int _degree = 3)
+	{
+		this->Clear();
+		const size_t count = _vProfile.size();
+		this->degree = std::min(std::max(_degree, 1), (int)MAXDEGREE);
+		this->z = count > 0 ? _vProfile.front().z : 1.0f;
+		const size_t p = (size_t)this->degree;
+		if (count < p + 1)
+		{
+			for (const VertexAttribute& var : _vProfile)
+			{
+				this->controls.push_back(glm::vec3(var.x, var.y, 1.0f));
+			}
+			this->degree = (int)std::max<size_t>(count, 1) - 1;
+			this->knots.assign(this->controls.size(), 0.0f);
+			this->knots.resize(2 * this->controls.size(), 1.0f);
+			return 0.0f;
+		}
+
+		// Chord-length parameters of the points
+		std::vector<GLfloat> param(count, 0.0f);
+		for (size_t i = 1; i < count; i++)
+		{
+			param[i] = param[i - 1] + std::hypot(_vProfile[i].x - _vProfile[i - 1].x, _vProfile[i].y - _vProfile[i - 1].y);
+		}
+		const GLfloat length = param.back();
+		for (GLfloat& u : param)
+		{
+			u = (length > 0.0f) ? u / length : 0.0f;
+		}
+		param.back() = 1.0f;
+
+		// Interior knots with an equal share of the points between them
+		const size_t maxControls = std::max(std::min(_maxControls, count), p + 1);
+		const size_t startControls = std::min<size_t>(std::max<size_t>(p + 1, 8), maxControls);
+		std::vector<GLfloat> interior;
+		for (size_t k = 1; k + p < startControls; k++)
+		{
+			interior.push_back(param[k * (count - 1) / (startControls - p)]);
+		}
+
+		GLfloat maxError = 0.0f, bestError = 0.0f;
+		std::vector<GLfloat> spanError, bestKnots;
+		std::vector<glm::vec3> bestControls;
+		for (;;)
+		{
+			this->knots.assign(p + 1, 0.0f);
+			this->knots.insert(this->knots.end(), interior.begin(), interior.end());
+			this->knots.resize(this->knots.size() + p + 1, 1.0f);
+			this->SolveControls(_vProfile, param);
+
+			// Distance of every point from the curve at its parameter, worst per knot span
+			std::vector<glm::vec2> fitted(count);
+			this->Evaluate(param.data(), count, fitted.data());
+			spanError.assign(this->knots.size(), 0.0f);
+			maxError = 0.0f;
+			for (size_t i = 0; i < count; i++)
+			{
+				GLfloat error = glm::length(fitted[i] - glm::vec2(_vProfile[i].x, _vProfile[i].y));
+				size_t span = this->FindSpan(param[i]);
+				spanError[span] = std::max(spanError[span], error);
+				maxError = std::max(maxError, error);
+			}
+			if (bestControls.empty() || maxError < bestError)
+			{
+				bestError = maxError;
+				bestKnots = this->knots;
+				bestControls = this->controls;
+			}
+			if (maxError <= _tolerance || this->controls.size() >= maxControls)
+			{
+				break;
+			}
+
+			// Split the spans that miss the tolerance and still hold enough points to constrain both halves,
+			// worst first while the control point budget lasts
+			std::vector<std::pair<GLfloat, GLfloat>> candidates;
+			size_t first = 0;
+			for (size_t span = p; span < this->controls.size(); span++)
+			{
+				while (first < count && param[first] < this->knots[span])
+				{
+					first++;
+				}
+				size_t last = first;
+				while (last < count && param[last] < this->knots[span + 1])
+				{
+					last++;
+				}
+				if (spanError[span] > std::max(_tolerance, 0.25f * maxError) && last - first >= 2 * p)
+				{
+					size_t median = first + (last - first) / 2;
+					candidates.push_back(std::make_pair(spanError[span], 0.5f * (param[median - 1] + param[median])));
+				}
+			}
+			if (candidates.empty())
+			{
+				break;
+			}
+			std::sort(candidates.begin(), candidates.end(), [](const std::pair<GLfloat, GLfloat>& a, const std::pair<GLfloat, GLfloat>& b) { return a.first > b.first; });
+			candidates.resize(std::min(candidates.size(), maxControls - this->controls.size()));
+			for (const std::pair<GLfloat, GLfloat>& candidate : candidates)
+			{
+				interior.push_back(candidate.second);
+			}
+			std::sort(interior.begin(), interior.end());
+		}
+
+		// Splitting can make the fit worse once spans run short of points; keep the best one seen
+		this->knots.swap(bestKnots);
+		this->controls.swap(bestControls);
+		this->fitError = bestError;
+		return bestError;
+	}
+
+	// Points of the curve at _count parameters in [0, 1]. De Boor's algorithm in homogeneous coordinates, run on
+	// BATCH parameters at a time with the triangle of every parameter in structure of arrays, so each step of the
+	// recursion is one loop over the batch that the compiler can vectorize.
+	void Evaluate(const GLfloat *_u, const size_t _count, glm::vec2 *_points) const
+	{
+		const int p = this->degree;
+		size_t span[BATCH];
+		GLfloat dx[MAXDEGREE + 1][BATCH], dy[MAXDEGREE + 1][BATCH], dw[MAXDEGREE + 1][BATCH];
+		for (size_t start = 0; start < _count; start += BATCH)
+		{
+			const size_t n = std::min((size_t)BATCH, _count - start);
+			const GLfloat *u = _u + start;
+			for (size_t i = 0; i < n; i++)
+			{
+				span[i] = this->FindSpan(u[i]);
+			}
+			for (int j = 0; j <= p; j++)
+			{
+				for (size_t i = 0; i < n; i++)
+				{
+					const glm::vec3& control = this->controls[span[i] - p + j];
+					dx[j][i] = control.x * control.z;
+					dy[j][i] = control.y * control.z;
+					dw[j][i] = control.z;
+				}
+			}
+			for (int r = 1; r <= p; r++)
+			{
+				for (int j = p; j >= r; j--)
+				{
+					for (size_t i = 0; i < n; i++)
+					{
+						const GLfloat left = this->knots[span[i] - p + j];
+						const GLfloat right = this->knots[span[i] + 1 + j - r];
+						const GLfloat alpha = (right > left) ? (u[i] - left) / (right - left) : 0.0f;
+						dx[j][i] = (1.0f - alpha) * dx[j - 1][i] + alpha * dx[j][i];
+						dy[j][i] = (1.0f - alpha) * dy[j - 1][i] + alpha * dy[j][i];
+						dw[j][i] = (1.0f - alpha) * dw[j - 1][i] + alpha * dw[j][i];
+					}
+				}
+			}
+			for (size_t i = 0; i < n; i++)
+			{
+				_points[start + i] = glm::vec2(dx[p][i] / dw[p][i], dy[p][i] / dw[p][i]);
+			}
+		}
+	}
+
+	// Profile points at the given parameters, in the layout LoadOutFile produces
+	void Evaluate(const std::vector<GLfloat>& _vU, std::vector<VertexAttribute>& _vProfile) const
+	{
+		std::vector<glm::vec2> points(_vU.size());
+		this->Evaluate(_vU.data(), _vU.size(), points.data());
+		_vProfile.resize(_vU.size());
+		for (size_t i = 0; i < _vU.size(); i++)
+		{
+			_vProfile[i] = { points[i].x, points[i].y, this->z, glm::vec3(0.0f, 0.0f, 0.0f) };
+		}
+	}
+
+	// Samples the curve into a profile whose polyline stays within _tolerance of it. Every knot span is bisected
+	// until the chord of each interval is within _tolerance at its quarter points; the intervals of one depth are
+	// all probed in a single Evaluate. Returns the largest chord deviation of the kept intervals.
+	GLfloat Sample(const GLfloat _tolerance, std::vector<VertexAttribute>& _vProfile) const
+	{
+		_vProfile.clear();
+		if (this->Empty())
+		{
+			return 0.0f;
+		}
+		const int maxDepth = 24;
+		std::vector<glm::vec2> intervals, next, probes;
+		std::vector<GLfloat> probeU, vU(1, 0.0f);
+		for (size_t span = this->degree; span < this->controls.size(); span++)
+		{
+			GLfloat u0 = this->knots[span], u1 = this->knots[span + 1];
+			if (u1 > u0)
+			{
+				intervals.push_back(glm::vec2(u0, 0.5f * (u0 + u1)));
+				intervals.push_back(glm::vec2(0.5f * (u0 + u1), u1));
+			}
+		}
+
+		GLfloat maxDeviation = 0.0f;
+		for (int depth = 0; !intervals.empty(); depth++)
+		{
+			probeU.resize(5 * intervals.size());
+			for (size_t i = 0; i < intervals.size(); i++)
+			{
+				for (int q = 0; q <= 4; q++)
+				{
+					probeU[5 * i + q] = intervals[i].x + (intervals[i].y - intervals[i].x) * q / 4.0f;
+				}
+			}
+			probes.resize(probeU.size());
+			this->Evaluate(probeU.data(), probeU.size(), probes.data());
+
+			next.clear();
+			for (size_t i = 0; i < intervals.size(); i++)
+			{
+				const glm::vec2 a = probes[5 * i], ab = probes[5 * i + 4] - a;
+				GLfloat deviation = 0.0f;
+				for (int q = 1; q <= 3; q++)
+				{
+					glm::vec2 ap = probes[5 * i + q] - a;
+					GLfloat t = glm::dot(ab, ab) > 0.0f ? glm::clamp(glm::dot(ap, ab) / glm::dot(ab, ab), 0.0f, 1.0f) : 0.0f;
+					deviation = std::max(deviation, glm::length(ap - t * ab));
+				}
+				if (deviation > _tolerance && depth < maxDepth)
+				{
+					GLfloat mid = 0.5f * (intervals[i].x + intervals[i].y);
+					next.push_back(glm::vec2(intervals[i].x, mid));
+					next.push_back(glm::vec2(mid, intervals[i].y));
+				}
+				else
+				{
+					vU.push_back(intervals[i].y);
+					maxDeviation = std::max(maxDeviation, deviation);
+				}
+			}
+			intervals.swap(next);
+		}
+
+		std::sort(vU.begin(), vU.end());
+		this->Evaluate(vU, _vProfile);
+		_vProfile.front().x = this->controls.front().x;
+		_vProfile.front().y = this->controls.front().y;
+		_vProfile.back().x = this->controls.back().x;
+		_vProfile.back().y = this->controls.back().y;
+		return maxDeviation;
+	}
+
+private:
+	// Knot span [knots[s], knots[s + 1]) holding _u, between degree and controls.size() - 1
+	size_t FindSpan(const GLfloat _u) const
+	{
+		const size_t last = this->controls.size() - 1;
+		if (_u >= this->knots[last + 1])
+		{
+			return last;
+		}
+		size_t span = std::upper_bound(this->knots.begin(), this->knots.end(), _u) - this->knots.begin() - 1;
+		return std::min(std::max(span, (size_t)this->degree), last);
+	}
+
+	// Non-zero basis functions N[span - degree .. span] at _u (Cox-de Boor, in the triangular form)
+	void BasisFunctions(const size_t _span, const GLfloat _u, GLfloat *_basis) const
+	{
+		GLfloat left[MAXDEGREE + 1], right[MAXDEGREE + 1];
+		_basis[0] = 1.0f;
+		for (int j = 1; j <= this->degree; j++)
+		{
+			left[j] = _u - this->knots[_span + 1 - j];
+			right[j] = this->knots[_span + j] - _u;
+			GLfloat saved = 0.0f;
+			for (int r = 0; r < j; r++)
+			{
+				GLfloat denominator = right[r + 1] + left[j - r];
+				GLfloat temp = (denominator != 0.0f) ? _basis[r] / denominator : 0.0f;
+				_basis[r] = saved + right[r + 1] * temp;
+				saved = left[j - r] * temp;
+			}
+			_basis[j] = saved;
+		}
+	}
+
+	// Least-squares control points for the current knots, with the first and last one pinned to the end points
+	void SolveControls(const std::vector<VertexAttribute>& _vProfile, const std::vector<GLfloat>& _param)
+	{
+		const size_t p = (size_t)this->degree;
+		const size_t controlCount = this->knots.size() - p - 1;
+		const size_t count = _vProfile.size();
+		const glm::vec2 first(_vProfile.front().x, _vProfile.front().y), last(_vProfile.back().x, _vProfile.back().y);
+		this->controls.assign(controlCount, glm::vec3(0.0f, 0.0f, 1.0f));
+		this->controls.front() = glm::vec3(first, 1.0f);
+		this->controls.back() = glm::vec3(last, 1.0f);
+		if (controlCount <= 2)
+		{
+			return;
+		}
+
+		// Normal equations of the interior control points
+		const size_t unknowns = controlCount - 2;
+		Eigen::MatrixXd normal = Eigen::MatrixXd::Zero(unknowns, unknowns);
+		Eigen::MatrixXd rhs = Eigen::MatrixXd::Zero(unknowns, 2);
+		GLfloat basis[MAXDEGREE + 1];
+		for (size_t i = 0; i < count; i++)
+		{
+			const size_t span = this->FindSpan(_param[i]);
+			this->BasisFunctions(span, _param[i], basis);
+			glm::vec2 residual(_vProfile[i].x, _vProfile[i].y);
+			for (size_t j = 0; j <= p; j++)
+			{
+				size_t control = span - p + j;
+				if (control == 0)
+				{
+					residual -= basis[j] * first;
+				}
+				else if (control == controlCount - 1)
+				{
+					residual -= basis[j] * last;
+				}
+			}
+			for (size_t j = 0; j <= p; j++)
+			{
+				size_t row = span - p + j;
+				if (row == 0 || row == controlCount - 1)
+				{
+					continue;
+				}
+				for (size_t k = 0; k <= p; k++)
+				{
+					size_t column = span - p + k;
+					if (column != 0 && column != controlCount - 1)
+					{
+						normal(row - 1, column - 1) += basis[j] * basis[k];
+					}
+				}
+				rhs(row - 1, 0) += basis[j] * residual.x;
+				rhs(row - 1, 1) += basis[j] * residual.y;
+			}
+		}
+		Eigen::MatrixXd solution = normal.ldlt().solve(rhs);
+		for (size_t c = 0; c < unknowns; c++)
+		{
+			this->controls[c + 1] = glm::vec3((GLfloat)solution(c, 0), (GLfloat)solution(c, 1), 1.0f);
+		}
+	}
+};
@@ -0,0 +1,177 @@
+#pragma once
+
+// Std. Includes
+#include <algorithm>
+#include <iostream>
+#include <vector>
+
+// GL Includes
+#include <GL/glew.h>
+
+// A buffer for data that changes every frame. With ARB_buffer_storage it is REGIONS regions of immutable storage,
+// mapped once with GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT and written in turn: frame n writes region n % REGIONS
+// while the GPU may still read the two before it. A fence after each frame's last read guards the region; Begin only
+// waits on it if the GPU is more than REGIONS - 1 frames behind, and counts the frames where it had to.
+// On plain GL 3.3 the same calls write a staging copy that End uploads with glBufferSubData after orphaning the
+// storage, so the driver hands out fresh memory instead of waiting for the previous frame's draws.
+class StreamBuffer
+{
+public:
+	static const size_t REGIONS = 3;
+
+	StreamBuffer() : buffer(0), regionBytes(0), region(0), persistent(false), mapped(nullptr), writing(0), stalls(0)
+	{
+		for (GLsync& fence : this->fences)
+		{
+			fence = 0;
+		}
+	}
+
+	~StreamBuffer()
+	{
+		this->Release();
+	}
+
+	StreamBuffer(const StreamBuffer&) = delete;
+	StreamBuffer& operator=(const StreamBuffer&) = delete;
+
+	// (Re)creates the buffer for up to _regionBytes per frame; _allowPersistent = false forces the GL 3.3 path
+	bool Create(const size_t _regionBytes, const bool _allowPersistent = true)
+	{
+		this->Release();
+		this->regionBytes = _regionBytes;
+		this->persistent = _allowPersistent && (GLEW_VERSION_4_4 || GLEW_ARB_buffer_storage);
+		glGenBuffers(1, &this->buffer);
+		glBindBuffer(GL_COPY_WRITE_BUFFER, this->buffer);
+		if (this->persistent)
+		{
+			const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+			glBufferStorage(GL_COPY_WRITE_BUFFER, REGIONS * _regionBytes, NULL, flags);
+			this->mapped = (unsigned char*)glMapBufferRange(GL_COPY_WRITE_BUFFER, 0, REGIONS * _regionBytes, flags);
+			if (nullptr == this->mapped)
+			{
+				std::cout << "ERROR::STREAM::MAP_FAILED, falling back to glBufferSubData" << std::endl;
+				glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+				glDeleteBuffers(1, &this->buffer);
+				this->buffer = 0;
+				return this->Create(_regionBytes, false);
+			}
+		}
+		else
+		{
+			glBufferData(GL_COPY_WRITE_BUFFER, _regionBytes, NULL, GL_STREAM_DRAW);
+			this->vStaging.resize(_regionBytes);
+		}
+		glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+		return true;
+	}
+
+	// Starts this frame's write of up to the region size; returns where to write _bytes
+	void* Begin(const size_t _bytes)
+	{
+		this->writing = std::min(_bytes, this->regionBytes);
+		if (!this->persistent)
+		{
+			return this->vStaging.data();
+		}
+		this->region = (this->region + 1) % REGIONS;
+		GLsync& fence = this->fences[this->region];
+		if (0 != fence)
+		{
+			if (glClientWaitSync(fence, 0, 0) == GL_TIMEOUT_EXPIRED)
+			{
+				this->stalls++;
+				while (glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000) == GL_TIMEOUT_EXPIRED)
+				{
+				}
+			}
+			glDeleteSync(fence);
+			fence = 0;
+		}
+		return this->mapped + this->region * this->regionBytes;
+	}
+
+	// Finishes the write; returns the byte offset of this frame's data in the buffer
+	size_t End()
+	{
+		if (!this->persistent)
+		{
+			glBindBuffer(GL_COPY_WRITE_BUFFER, this->buffer);
+			glBufferData(GL_COPY_WRITE_BUFFER, this->regionBytes, NULL, GL_STREAM_DRAW);
+			glBufferSubData(GL_COPY_WRITE_BUFFER, 0, this->writing, this->vStaging.data());
+			glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+			return 0;
+		}
+		// Coherent mapping: the writes are visible to commands issued from here on
+		return this->region * this->regionBytes;
+	}
+
+	// Marks the end of this frame's reads of the current region; call after the last command that reads it
+	void Fence()
+	{
+		if (this->persistent)
+		{
+			if (0 != this->fences[this->region])
+			{
+				glDeleteSync(this->fences[this->region]);
+			}
+			this->fences[this->region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+		}
+	}
+
+	GLuint GetBuffer() const
+	{
+		return this->buffer;
+	}
+
+	bool IsPersistent() const
+	{
+		return this->persistent;
+	}
+
+	// Frames whose Begin had to wait for the GPU, since Create or the last call
+	size_t TakeStalls()
+	{
+		size_t count = this->stalls;
+		this->stalls = 0;
+		return count;
+	}
+
+	void Release()
+	{
+		for (GLsync& fence : this->fences)
+		{
+			if (0 != fence)
+			{
+				glDeleteSync(fence);
+				fence = 0;
+			}
+		}
+		if (0 != this->buffer)
+		{
+			if (nullptr != this->mapped)
+			{
+				glBindBuffer(GL_COPY_WRITE_BUFFER, this->buffer);
+				glUnmapBuffer(GL_COPY_WRITE_BUFFER);
+				glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+			}
+			glDeleteBuffers(1, &this->buffer);
+		}
+		this->buffer = 0;
+		this->mapped = nullptr;
+		this->region = 0;
+		this->stalls = 0;
+		std::vector<unsigned char>().swap(this->vStaging);
+	}
+
+private:
+	GLuint buffer;
+	size_t regionBytes;
+	size_t region;	// Region of the current frame
+	bool persistent;
+	unsigned char* mapped;
+	size_t writing;
+	size_t stalls;
+	GLsync fences[REGIONS];
+	std::vector<unsigned char> vStaging;	// GL 3.3 path
+};
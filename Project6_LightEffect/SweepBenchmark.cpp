@@ -0,0 +1,65 @@
+// Headless propeller design sweep: builds every variant of a parameter grid into one arena and reports meshes/s.
+// Usage: SweepBenchmark [profile.out] [max threads] [sweep output file]
+// The grid is blade count x hub radius x section scale offset x section spacing x section count; the run is
+// repeated on 1, 2, 4, ... worker threads and the last arena is written out when an output file is given.
+// An untimed run first zero-fills and faults in the arena, which would otherwise only count against 1 thread.
+#include <iostream>
+#include <vector>
+#include <cstdlib>
+#include <thread>
+
+// GLEW
+#include <GL/glew.h>
+
+// GLM
+#include <glm/glm.hpp>
+
+// Other includes
+#include "VertexAttribute.h"
+#include "AirfoilLoader.h"
+#include "ProfileResampler.h"
+#include "PropellerSweep.h"
+
+const GLfloat SWEEPTOLERANCE = 1e-3f;	// Profile resampling for the sweep, coarser than the viewer's
+
+int main(int argc, char *argv[])
+{
+	const char *profilePath = (argc > 1) ? argv[1] : "foil_spline.out";
+	unsigned maxThreads = (argc > 2) ? std::atoi(argv[2]) : std::max(1u, std::thread::hardware_concurrency());
+	const char *outputPath = (argc > 3) ? argv[3] : nullptr;
+
+	std::vector<VertexAttribute> vProfile, vResampled;
+	if (!LoadOutProfile(profilePath, vProfile) || vProfile.empty())
+	{
+		std::cout << "ERROR::BENCHMARK::PROFILE_NOT_LOADED " << profilePath << std::endl;
+		return EXIT_FAILURE;
+	}
+	ResampleResult resampled = ResampleProfile(vProfile, SWEEPTOLERANCE, vResampled);
+	std::cout << profilePath << ": " << resampled.inputPoints << " -> " << resampled.outputPoints << " profile points" << std::endl;
+
+	PropellerGrid grid;
+	grid.vBladeCount = { 2, 3, 4, 5, 6 };
+	grid.vHubRadius = { 2.0f, 2.5f, 3.0f, 3.5f, 4.0f };
+	grid.vScaleOffset = { 1.5f, 2.5f, 3.5f, 4.5f };
+	grid.vSectionSpacing = { 2.0f, 2.5f, 3.0f };
+	grid.vSections = { 5, 10, 15 };
+	std::vector<PropellerParams> vParams = grid.Expand();
+
+	PropellerSweep sweep;
+	sweep.Generate(vResampled, vParams, 1);
+	for (unsigned threads = 1; threads <= maxThreads; threads *= 2)
+	{
+		sweep.Generate(vResampled, vParams, threads);
+		sweep.Report(std::cout);
+	}
+
+	if (outputPath != nullptr)
+	{
+		if (!sweep.Write(outputPath))
+		{
+			return EXIT_FAILURE;
+		}
+		std::cout << "written to " << outputPath << std::endl;
+	}
+	return EXIT_SUCCESS;
+}
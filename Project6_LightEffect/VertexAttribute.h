@@ -0,0 +1,14 @@
+#pragma once
+
+// GL Includes
+#include <GL/glew.h>
+
+#include <glm/glm.hpp>
+
+// Interleaved vertex layout shared by the loaders, the mesh builders and the VBO uploads
+typedef struct _vertexAttri
+{
+	GLfloat x, y, z;
+	glm::vec3 normal;
+	GLfloat span = 0.0f;	// Blade section (foilNum) the vertex was lofted in, 0 at the root and off the blade
+}VertexAttribute;
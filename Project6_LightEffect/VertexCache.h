@@ -0,0 +1,214 @@
+#pragma once
+
+// Std. Includes
+#include <iostream>
+#include <vector>
+
+// GL Includes
+#include <GL/glew.h>
+
+// Other includes
+#include "VertexAttribute.h"
+
+// Post-transform cache behaviour of an index buffer, measured on a FIFO cache
+struct VertexCacheStats
+{
+	GLfloat acmr;	// Average cache miss ratio: vertex shader runs per triangle, 0.5 at best for large grids, 3 at worst
+	GLfloat atvr;	// Average transformed vertex ratio: vertex shader runs per vertex, 1 at best
+};
+
+// Simulates a FIFO post-transform cache of _cacheSize entries over the triangle list _vIndices
+inline VertexCacheStats AnalyzeVertexCache(const std::vector<GLuint>& _vIndices, const size_t _vertexCount, const size_t _cacheSize = 16)
+{
+	VertexCacheStats stats = { 0.0f, 0.0f };
+	if (_vIndices.size() < 3 || _vertexCount == 0)
+	{
+		return stats;
+	}
+
+	// A vertex is in the cache while fewer than _cacheSize misses happened since it was loaded
+	std::vector<size_t> vLoaded(_vertexCount, 0);
+	size_t misses = 0;
+	for (GLuint index : _vIndices)
+	{
+		if (vLoaded[index] == 0 || misses - vLoaded[index] + 1 > _cacheSize)
+		{
+			++misses;
+			vLoaded[index] = misses;
+		}
+	}
+
+	stats.acmr = (GLfloat)misses / (GLfloat)(_vIndices.size() / 3);
+	stats.atvr = (GLfloat)misses / (GLfloat)_vertexCount;
+	return stats;
+}
+
+// Reorders the triangles of _vIndices for a post-transform cache of _cacheSize entries, using Tipsify
+// (Sander, Nehab and Barczak, "Fast Triangle Reordering for Vertex Locality and Reduced Overdraw", 2007).
+// Triangles are emitted as fans around one vertex at a time; the next fanning vertex is a neighbour that
+// will still be in the cache after its own remaining triangles, or a dead end from the stack.
+inline void OptimizeVertexCache(std::vector<GLuint>& _vIndices, const size_t _vertexCount, const size_t _cacheSize = 16)
+{
+	const size_t triangleCount = _vIndices.size() / 3;
+	if (triangleCount == 0 || _vertexCount == 0)
+	{
+		return;
+	}
+
+	// Vertex to triangle adjacency, as offsets into one array
+	std::vector<GLuint> vLive(_vertexCount, 0);
+	for (size_t i = 0; i < triangleCount * 3; i++)
+	{
+		vLive[_vIndices[i]]++;
+	}
+	std::vector<size_t> vOffset(_vertexCount + 1, 0);
+	for (size_t v = 0; v < _vertexCount; v++)
+	{
+		vOffset[v + 1] = vOffset[v] + vLive[v];
+	}
+	std::vector<GLuint> vAdjacency(vOffset[_vertexCount]);
+	std::vector<size_t> vFill(vOffset.begin(), vOffset.end() - 1);
+	for (size_t t = 0; t < triangleCount; t++)
+	{
+		for (size_t c = 0; c < 3; c++)
+		{
+			vAdjacency[vFill[_vIndices[t * 3 + c]]++] = (GLuint)t;
+		}
+	}
+
+	std::vector<size_t> vCacheTime(_vertexCount, 0);
+	std::vector<bool> vEmitted(triangleCount, false);
+	std::vector<GLuint> vDeadEnd;
+	std::vector<GLuint> vCandidate;
+	std::vector<GLuint> vOutput;
+	vOutput.reserve(triangleCount * 3);
+
+	size_t time = _cacheSize + 1;
+	size_t cursor = 0;
+	long long fan = 0;
+	while (fan >= 0)
+	{
+		vCandidate.clear();
+		for (size_t a = vOffset[fan]; a < vOffset[fan + 1]; a++)
+		{
+			GLuint t = vAdjacency[a];
+			if (vEmitted[t])
+			{
+				continue;
+			}
+			for (size_t c = 0; c < 3; c++)
+			{
+				GLuint v = _vIndices[t * 3 + c];
+				vOutput.push_back(v);
+				vDeadEnd.push_back(v);
+				vCandidate.push_back(v);
+				vLive[v]--;
+				if (time - vCacheTime[v] > _cacheSize)
+				{
+					vCacheTime[v] = time++;
+				}
+			}
+			vEmitted[t] = true;
+		}
+
+		// Prefer the candidate that entered the cache earliest but will stay there while its fan is emitted
+		fan = -1;
+		long long bestPriority = -1;
+		for (GLuint v : vCandidate)
+		{
+			if (vLive[v] == 0)
+			{
+				continue;
+			}
+			long long priority = 0;
+			if (time - vCacheTime[v] + 2 * vLive[v] <= _cacheSize)
+			{
+				priority = (long long)(time - vCacheTime[v]);
+			}
+			if (priority > bestPriority)
+			{
+				bestPriority = priority;
+				fan = v;
+			}
+		}
+
+		// Dead end: back up through recently used vertices, then continue with the next vertex in input order
+		while (fan < 0 && !vDeadEnd.empty())
+		{
+			GLuint v = vDeadEnd.back();
+			vDeadEnd.pop_back();
+			if (vLive[v] > 0)
+			{
+				fan = v;
+			}
+		}
+		while (fan < 0 && cursor < _vertexCount)
+		{
+			if (vLive[cursor] > 0)
+			{
+				fan = (long long)cursor;
+			}
+			cursor++;
+		}
+	}
+
+	// Leftover indices past the last whole triangle are kept as they were
+	vOutput.insert(vOutput.end(), _vIndices.begin() + triangleCount * 3, _vIndices.end());
+	_vIndices.swap(vOutput);
+}
+
+const GLuint UNUSEDVERTEX = ~0u;
+
+// Reorders _vVertex into the order _vIndices first references them, so vertex fetches walk memory forward.
+// Vertices no index refers to are moved to the end. Returns the new position of every old vertex, for other
+// index buffers over the same vertices.
+inline std::vector<GLuint> OptimizeVertexFetch(std::vector<VertexAttribute>& _vVertex, std::vector<GLuint>& _vIndices)
+{
+	std::vector<GLuint> vRemap(_vVertex.size(), UNUSEDVERTEX);
+	std::vector<VertexAttribute> vOrdered;
+	vOrdered.reserve(_vVertex.size());
+	for (GLuint& index : _vIndices)
+	{
+		if (vRemap[index] == UNUSEDVERTEX)
+		{
+			vRemap[index] = (GLuint)vOrdered.size();
+			vOrdered.push_back(_vVertex[index]);
+		}
+		index = vRemap[index];
+	}
+	for (size_t v = 0; v < _vVertex.size(); v++)
+	{
+		if (vRemap[v] == UNUSEDVERTEX)
+		{
+			vRemap[v] = (GLuint)vOrdered.size();
+			vOrdered.push_back(_vVertex[v]);
+		}
+	}
+	_vVertex.swap(vOrdered);
+	return vRemap;
+}
+
+// Applies a table from OptimizeVertexFetch to another index buffer; _keep (such as a primitive restart index) is left as is
+inline void RemapIndices(std::vector<GLuint>& _vIndices, const std::vector<GLuint>& _vRemap, const GLuint _keep = UNUSEDVERTEX)
+{
+	for (GLuint& index : _vIndices)
+	{
+		if (index != _keep)
+		{
+			index = _vRemap[index];
+		}
+	}
+}
+
+// Runs both passes on a mesh and prints its ACMR and ATVR before and after; returns the vertex remap table
+inline std::vector<GLuint> OptimizeMesh(const char* _name, std::vector<VertexAttribute>& _vVertex, std::vector<GLuint>& _vIndices, const size_t _cacheSize = 16)
+{
+	VertexCacheStats before = AnalyzeVertexCache(_vIndices, _vVertex.size(), _cacheSize);
+	OptimizeVertexCache(_vIndices, _vVertex.size(), _cacheSize);
+	std::vector<GLuint> vRemap = OptimizeVertexFetch(_vVertex, _vIndices);
+	VertexCacheStats after = AnalyzeVertexCache(_vIndices, _vVertex.size(), _cacheSize);
+
+	std::cout << _name << " vertex cache (" << _cacheSize << " entries): ACMR " << before.acmr << " -> " << after.acmr
+		<< ", ATVR " << before.atvr << " -> " << after.atvr << std::endl;
+	return vRemap;
+}
@@ -0,0 +1,201 @@
+#pragma once
+
+// Std. Includes
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <vector>
+
+// GL Includes
+#include <GL/glew.h>
+
+#include <glm/glm.hpp>
+
+// Other includes
+#include "VertexAttribute.h"
+
+// What a WeldVertices pass removed
+struct WeldResult
+{
+	size_t inputVertices;
+	size_t outputVertices;
+	size_t inputTriangles;
+	size_t outputTriangles;
+	size_t collapsedTriangles;	// Two corners welded into one vertex
+	size_t flatTriangles;	// Three distinct corners, but no area
+};
+
+// Hash grid of the vertices kept so far, cells 2 * _epsilon wide. Open addressing on the cell key, each slot heading
+// a list of kept vertices through vNext. Everything within _epsilon of a point lies in the 2 x 2 x 2 block of cells
+// nearest to it, so a lookup touches 8 cells and nothing else.
+class WeldGrid
+{
+public:
+	WeldGrid(const size_t _vertexCount, const GLfloat _epsilon) : inverseCell(0.5f / _epsilon)
+	{
+		size_t slots = 16;
+		this->shift = 60;
+		while (slots < 2 * _vertexCount)
+		{
+			slots *= 2;
+			this->shift--;
+		}
+		vKey.assign(slots, (uint64_t)EMPTYKEY);
+		vHead.assign(slots, (GLuint)NOVERTEX);
+		vNext.reserve(_vertexCount);
+	}
+
+	static const GLuint NOVERTEX = 0xFFFFFFFFu;
+
+	glm::ivec3 Cell(const VertexAttribute& _vertex) const
+	{
+		return glm::ivec3((int)std::floor(_vertex.x * this->inverseCell), (int)std::floor(_vertex.y * this->inverseCell), (int)std::floor(_vertex.z * this->inverseCell));
+	}
+
+	// Lowest corner of the 2 x 2 x 2 cells around _vertex: per axis its own cell and the neighbour on its nearer side
+	glm::ivec3 Block(const VertexAttribute& _vertex) const
+	{
+		return glm::ivec3((int)std::floor(_vertex.x * this->inverseCell - 0.5f), (int)std::floor(_vertex.y * this->inverseCell - 0.5f), (int)std::floor(_vertex.z * this->inverseCell - 0.5f));
+	}
+
+	// First kept vertex of _cell, NOVERTEX if there is none
+	GLuint Head(const glm::ivec3& _cell) const
+	{
+		size_t slot = this->Find(Key(_cell));
+		return (this->vKey[slot] == EMPTYKEY) ? NOVERTEX : this->vHead[slot];
+	}
+
+	GLuint Next(const GLuint _kept) const
+	{
+		return this->vNext[_kept];
+	}
+
+	// Adds kept vertex number _kept (numbered in insertion order) to _cell
+	void Insert(const glm::ivec3& _cell, const GLuint _kept)
+	{
+		const uint64_t key = Key(_cell);
+		size_t slot = this->Find(key);
+		this->vKey[slot] = key;
+		this->vNext.push_back(this->vHead[slot]);
+		this->vHead[slot] = _kept;
+	}
+
+private:
+	static const uint64_t EMPTYKEY = ~(uint64_t)0;
+
+	GLfloat inverseCell;
+	int shift;	// 64 - log2(slots)
+	std::vector<uint64_t> vKey;
+	std::vector<GLuint> vHead;
+	std::vector<GLuint> vNext;
+
+	// 21 bits per axis, enough for 10^6 cells of _epsilon in every direction
+	static uint64_t Key(const glm::ivec3& _cell)
+	{
+		const uint64_t mask = (1u << 21) - 1;
+		return ((uint64_t)(_cell.x & mask) << 42) | ((uint64_t)(_cell.y & mask) << 21) | (uint64_t)(_cell.z & mask);
+	}
+
+	size_t Find(const uint64_t _key) const
+	{
+		const size_t mask = this->vKey.size() - 1;
+		// Fibonacci hashing: the top bits of the product depend on every bit of the key
+		size_t slot = (size_t)((_key * 0x9E3779B97F4A7C15ull) >> this->shift);
+		while (this->vKey[slot] != EMPTYKEY && this->vKey[slot] != _key)
+		{
+			slot = (slot + 1) & mask;
+		}
+		return slot;
+	}
+};
+
+// Merges vertices closer than _epsilon into the first of them and drops the triangles that no longer cover any
+// area: those with two corners on the same vertex, and those whose area is below _epsilon^2 / 2. Vertices are only
+// merged if their normals are within acos(_normalCosine) of each other; -1 welds by position alone,
+// larger values keep sharp edges (such as the blade's trailing edge) split. Expected O(n): every vertex probes the
+// 8 grid cells around it. _vVertex keeps the first vertex of each group, in their original order. Returns the
+// table from old to new vertex numbers, for other index buffers of the mesh (RemapIndices).
+inline std::vector<GLuint> WeldVertices(std::vector<VertexAttribute>& _vVertex, std::vector<GLuint>& _vIndices, const GLfloat _epsilon, const GLfloat _normalCosine, WeldResult& _result)
+{
+	_result.inputVertices = _vVertex.size();
+	_result.inputTriangles = _vIndices.size() / 3;
+	_result.collapsedTriangles = 0;
+	_result.flatTriangles = 0;
+	std::vector<GLuint> vRemap(_vVertex.size());
+	const GLfloat epsilon = std::max(_epsilon, 1e-12f);
+	const GLfloat epsilon2 = epsilon * epsilon;
+
+	// 1. Map every vertex to the first kept vertex within _epsilon, or keep it
+	WeldGrid grid(_vVertex.size(), epsilon);
+	std::vector<VertexAttribute> vKept;
+	vKept.reserve(_vVertex.size());
+	for (size_t v = 0; v < _vVertex.size(); v++)
+	{
+		const VertexAttribute& vertex = _vVertex[v];
+		const glm::vec3 position(vertex.x, vertex.y, vertex.z);
+		const glm::ivec3 cell = grid.Cell(vertex), block = grid.Block(vertex);
+		GLuint match = WeldGrid::NOVERTEX;
+		for (int dz = 0; dz <= 1 && match == WeldGrid::NOVERTEX; dz++)
+			for (int dy = 0; dy <= 1 && match == WeldGrid::NOVERTEX; dy++)
+				for (int dx = 0; dx <= 1 && match == WeldGrid::NOVERTEX; dx++)
+				{
+					for (GLuint kept = grid.Head(block + glm::ivec3(dx, dy, dz)); kept != WeldGrid::NOVERTEX; kept = grid.Next(kept))
+					{
+						const VertexAttribute& other = vKept[kept];
+						glm::vec3 d = position - glm::vec3(other.x, other.y, other.z);
+						if (glm::dot(d, d) <= epsilon2 && glm::dot(vertex.normal, other.normal) >= _normalCosine)
+						{
+							match = kept;
+							break;
+						}
+					}
+				}
+		if (match == WeldGrid::NOVERTEX)
+		{
+			match = (GLuint)vKept.size();
+			grid.Insert(cell, match);
+			vKept.push_back(vertex);
+		}
+		vRemap[v] = match;
+	}
+
+	// 2. Remap the triangles and keep those that still have area
+	size_t out = 0;
+	for (size_t t = 0; t + 2 < _vIndices.size(); t += 3)
+	{
+		GLuint a = vRemap[_vIndices[t]], b = vRemap[_vIndices[t + 1]], c = vRemap[_vIndices[t + 2]];
+		if (a == b || b == c || a == c)
+		{
+			_result.collapsedTriangles++;
+			continue;
+		}
+		glm::vec3 pa(vKept[a].x, vKept[a].y, vKept[a].z);
+		glm::vec3 ab = glm::vec3(vKept[b].x, vKept[b].y, vKept[b].z) - pa, ac = glm::vec3(vKept[c].x, vKept[c].y, vKept[c].z) - pa;
+		if (glm::length(glm::cross(ab, ac)) < epsilon2)
+		{
+			_result.flatTriangles++;
+			continue;
+		}
+		_vIndices[out++] = a;
+		_vIndices[out++] = b;
+		_vIndices[out++] = c;
+	}
+	_vIndices.resize(out);
+	_vVertex.swap(vKept);
+
+	_result.outputVertices = _vVertex.size();
+	_result.outputTriangles = _vIndices.size() / 3;
+	return vRemap;
+}
+
+// Welds a mesh and prints what was removed; returns the vertex remap table
+inline std::vector<GLuint> WeldMesh(const char* _name, std::vector<VertexAttribute>& _vVertex, std::vector<GLuint>& _vIndices, const GLfloat _epsilon, const GLfloat _normalCosine = -1.0f)
+{
+	WeldResult result;
+	std::vector<GLuint> vRemap = WeldVertices(_vVertex, _vIndices, _epsilon, _normalCosine, result);
+	std::cout << _name << " weld (epsilon " << _epsilon << "): " << result.inputVertices - result.outputVertices << " of " << result.inputVertices
+		<< " vertices merged, " << result.collapsedTriangles << " collapsed and " << result.flatTriangles << " flat of "
+		<< result.inputTriangles << " triangles removed" << std::endl;
+	return vRemap;
+}